@@ -0,0 +1,604 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+#else
+#include <unistd.h>
+#endif
+
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelMetrics.h"
+
+char archivePrefix[MAX_PATH_LEN] = ARCHIVE_PREFIX;
+ArchivePartition* archivePartitions = NULL;
+int archivePartitionCount = 0;
+int archivePartitionCapacity = 0;
+int archivedThroughDay = 0;
+int archivedThroughMinute = 0;
+ArchiveBlock* archiveBlocks = NULL; // Blocks being filled by the current expiry sweep
+int archiveBlockCount = 0;
+int archiveCommitPending = 0; // Records are packed that no successful commit has covered yet
+int pendingThroughDay = 0;    // Latest watermark a failed commit was given
+int pendingThroughMinute = 0;
+
+// Scratch state of archiveReport
+typedef struct ArchiveReportScan {
+    int firstMonth;
+    int monthCount;
+    ArchiveMonthReport* report;
+} ArchiveReportScan;
+
+// Varint helpers used only in this file
+unsigned char* putVarint(unsigned char* out, unsigned int value);
+int getVarint(const unsigned char** in, const unsigned char* end, unsigned int* value);
+unsigned int zigzag(int value);
+int unzigzag(unsigned int value);
+
+void openArchive() {
+    loadArchiveManifest();
+}
+
+void closeArchive() {
+    int i;
+    for (i = 0; i < archiveBlockCount; i++) {
+        free(archiveBlocks[i].data);
+        free(archiveBlocks[i].stringOffsets);
+        free(archiveBlocks[i].dictionary);
+    }
+    free(archiveBlocks);
+    archiveBlocks = NULL;
+    archiveBlockCount = 0;
+
+    free(archivePartitions);
+    archivePartitions = NULL;
+    archivePartitionCount = 0;
+    archivePartitionCapacity = 0;
+    archivedThroughDay = 0;
+    archivedThroughMinute = 0;
+    archiveCommitPending = 0;
+    pendingThroughDay = 0;
+    pendingThroughMinute = 0;
+}
+
+// Delete the manifest and every partition it lists
+void removeArchiveFiles() {
+    char path[ARCHIVE_PATH_LEN];
+    int i;
+
+    loadArchiveManifest();
+    for (i = 0; i < archivePartitionCount; i++) {
+        archivePartitionPath(archivePartitions[i].month, path);
+        remove(path);
+    }
+    snprintf(path, sizeof(path), "%s.arc", archivePrefix);
+    remove(path);
+    closeArchive();
+}
+
+// Pack an expired reservation into the block of its check-out month. Nothing
+// is on disk until commitArchive, except blocks that fill up on the way.
+// Returns 0 if the reservation could not be packed.
+int archiveReservation(Reservation* reservation) {
+    int slot = findRoomSlot(reservation->roomNumber);
+    const RoomType* type = slot >= 0 ? &roomTypes[rooms[slot].typeId] : NULL;
+    ArchiveBlock* block = getArchiveBlock(dayToMonth(reservation->checkOutDay));
+
+    if (block == NULL) {
+        return 0;
+    }
+    if (block->header.records == ARCHIVE_BLOCK_RECORDS && !writeArchiveBlock(block)) {
+        return 0;
+    }
+    if (block->header.size + ARCHIVE_MAX_RECORD_LEN > block->capacity) {
+        size_t capacity = block->capacity * 2;
+        unsigned char* data = (unsigned char*)realloc(block->data, capacity);
+        if (data == NULL) {
+            return 0;
+        }
+        block->data = data;
+        block->capacity = capacity;
+    }
+
+    unsigned char* out = block->data + block->header.size;
+    out = putVarint(out, zigzag(reservation->checkOutDay - block->previousCheckOutDay));
+    out = putVarint(out, zigzag(reservation->checkOutDay - reservation->checkInDay));
+    out = putVarint(out, (unsigned int)reservation->checkInMinute);
+    out = putVarint(out, (unsigned int)reservation->checkOutMinute);
+    out = putVarint(out, (unsigned int)reservation->roomNumber);
+    out = putVarint(out, type != NULL ? (unsigned int)(type->pricePerNight * 100 + 0.5) : 0);
+    block->header.size = (unsigned int)(out - block->data);
+    packArchiveString(block, reservation->username);
+    packArchiveString(block, type != NULL ? type->name : "");
+
+    block->header.records++;
+    block->previousCheckOutDay = reservation->checkOutDay;
+    if (reservation->checkInDay < block->header.minCheckInDay) {
+        block->header.minCheckInDay = reservation->checkInDay;
+    }
+    if (reservation->checkOutDay > block->header.maxCheckOutDay) {
+        block->header.maxCheckOutDay = reservation->checkOutDay;
+    }
+    archiveCommitPending = 1;
+    metricsAdd(COUNTER_ARCHIVED, 1);
+    return 1;
+}
+
+// Write the blocks of a sweep and record that everything checking out before
+// throughDay/throughMinute is archived. Returns 0 if anything failed to write;
+// the blocks that did not make it keep their records and the watermark is
+// remembered, so calling again retries the whole commit.
+int commitArchive(int throughDay, int throughMinute) {
+    int success = 1;
+    int i;
+
+    if (compareDateTime(throughDay, throughMinute, pendingThroughDay, pendingThroughMinute) > 0) {
+        pendingThroughDay = throughDay;
+        pendingThroughMinute = throughMinute;
+    }
+    for (i = 0; i < archiveBlockCount; i++) {
+        if (!writeArchiveBlock(&archiveBlocks[i])) {
+            success = 0;
+        }
+    }
+
+    // The watermark only moves once every record before it is on disk
+    if (success && compareDateTime(pendingThroughDay, pendingThroughMinute, archivedThroughDay, archivedThroughMinute) > 0) {
+        archivedThroughDay = pendingThroughDay;
+        archivedThroughMinute = pendingThroughMinute;
+    }
+    success = saveArchiveManifest() && success;
+    archiveCommitPending = !success;
+    return success;
+}
+
+// Hand every archived stay that touches [fromDay, toDay) to visitor, oldest
+// partition first. Reads one block at a time. Returns 0 if a partition could
+// not be read completely.
+int scanArchive(int fromDay, int toDay, ArchiveVisitor visitor, void* context) {
+    unsigned long long start = metricsClock();
+    char path[ARCHIVE_PATH_LEN];
+    ArchiveBlockHeader header;
+    unsigned char* data = NULL;
+    size_t capacity = 0;
+    int firstMonth = dayToMonth(fromDay);
+    int success = 1;
+    int i;
+
+    for (i = 0; i < archivePartitionCount; i++) {
+        ArchivePartition* partition = &archivePartitions[i];
+        // Stays that end before the partition's month are all in earlier ones
+        if (partition->month < firstMonth || partition->minCheckInDay >= toDay || partition->maxCheckOutDay < fromDay) {
+            continue;
+        }
+
+        archivePartitionPath(partition->month, path);
+        FILE* file = fopen(path, "rb");
+        if (file == NULL) {
+            success = 0;
+            continue;
+        }
+
+        unsigned int offset = 0;
+        while (offset + sizeof(header) <= partition->size) {
+            if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != ARCHIVE_MAGIC ||
+                header.records > ARCHIVE_BLOCK_RECORDS || header.size > partition->size - offset - sizeof(header)) {
+                success = 0;
+                break;
+            }
+            offset += sizeof(header) + header.size;
+
+            if (header.minCheckInDay >= toDay || header.maxCheckOutDay < fromDay) {
+                fseek(file, offset, SEEK_SET);
+                continue;
+            }
+            if (header.size > capacity) {
+                capacity = header.size;
+                free(data);
+                data = (unsigned char*)malloc(capacity);
+            }
+            if (data == NULL || fread(data, 1, header.size, file) != header.size ||
+                snapshotChecksum(2166136261u, data, header.size) != header.checksum ||
+                !unpackArchiveBlock(&header, data, fromDay, toDay, visitor, context)) {
+                success = 0;
+                break;
+            }
+        }
+        fclose(file);
+    }
+
+    free(data);
+    metricsRecord(METRIC_ARCHIVE_SCAN, start);
+    return success;
+}
+
+// Stays, room nights and revenue for monthCount months from firstMonth
+int archiveReport(int firstMonth, int monthCount, ArchiveMonthReport report[]) {
+    ArchiveReportScan scan;
+    int i;
+
+    for (i = 0; i < monthCount; i++) {
+        memset(&report[i], 0, sizeof(ArchiveMonthReport));
+        report[i].month = firstMonth + i;
+    }
+    scan.firstMonth = firstMonth;
+    scan.monthCount = monthCount;
+    scan.report = report;
+    return scanArchive(monthStartDay(firstMonth), monthStartDay(firstMonth + monthCount), addToArchiveReport, &scan);
+}
+
+// Split a stay's nights over the months they fall in
+void addToArchiveReport(const ArchiveRecord* record, void* context) {
+    ArchiveReportScan* scan = (ArchiveReportScan*)context;
+    // A same-day stay is charged one night
+    int lastNight = record->checkOutDay > record->checkInDay ? record->checkOutDay : record->checkInDay + 1;
+    int day = record->checkInDay;
+    int month = dayToMonth(day);
+    int index;
+
+    while (day < lastNight) {
+        int nextMonth = monthStartDay(month + 1);
+        int until = nextMonth < lastNight ? nextMonth : lastNight;
+        index = month - scan->firstMonth;
+        if (index >= 0 && index < scan->monthCount) {
+            scan->report[index].roomNights += until - day;
+            scan->report[index].revenue += (until - day) * record->pricePerNight;
+        }
+        day = until;
+        month++;
+    }
+
+    index = dayToMonth(record->checkOutDay) - scan->firstMonth;
+    if (index >= 0 && index < scan->monthCount) {
+        scan->report[index].stays++;
+    }
+}
+
+// Read <prefix>.arc. A missing or damaged manifest means an empty archive.
+int loadArchiveManifest() {
+    ArchiveManifestHeader header;
+    char path[ARCHIVE_PATH_LEN];
+
+    closeArchive();
+    snprintf(path, sizeof(path), "%s.arc", archivePrefix);
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    int success = fread(&header, sizeof(header), 1, file) == 1 && header.magic == ARCHIVE_MAGIC &&
+                  header.version == ARCHIVE_VERSION && header.partitionCount <= INT_MAX / sizeof(ArchivePartition);
+    if (success) {
+        archivePartitions = (ArchivePartition*)malloc((header.partitionCount + 1) * sizeof(ArchivePartition));
+        success = archivePartitions != NULL &&
+                  fread(archivePartitions, sizeof(ArchivePartition), header.partitionCount, file) == header.partitionCount &&
+                  snapshotChecksum(2166136261u, archivePartitions, header.partitionCount * sizeof(ArchivePartition)) == header.checksum;
+    }
+    fclose(file);
+
+    if (!success) {
+        closeArchive();
+        return 0;
+    }
+    archivePartitionCount = (int)header.partitionCount;
+    archivePartitionCapacity = archivePartitionCount + 1;
+    archivedThroughDay = header.archivedThroughDay;
+    archivedThroughMinute = header.archivedThroughMinute;
+    return 1;
+}
+
+// Replace <prefix>.arc in one step, after the blocks it counts are on disk
+int saveArchiveManifest() {
+    ArchiveManifestHeader header;
+    char path[ARCHIVE_PATH_LEN];
+    char temporaryPath[ARCHIVE_PATH_LEN];
+
+    memset(&header, 0, sizeof(header));
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.partitionCount = (unsigned int)archivePartitionCount;
+    header.checksum = snapshotChecksum(2166136261u, archivePartitions, archivePartitionCount * sizeof(ArchivePartition));
+    header.archivedThroughDay = archivedThroughDay;
+    header.archivedThroughMinute = archivedThroughMinute;
+
+    snprintf(path, sizeof(path), "%s.arc", archivePrefix);
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.arc.tmp", archivePrefix);
+    FILE* file = fopen(temporaryPath, "wb");
+    if (file == NULL) {
+        return 0;
+    }
+    int success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(archivePartitions, sizeof(ArchivePartition), archivePartitionCount, file) ==
+                      (size_t)archivePartitionCount &&
+                  fflush(file) == 0 && fsync(fileno(file)) == 0;
+    fclose(file);
+
+    if (!success || !replaceFile(temporaryPath, path)) {
+        remove(temporaryPath);
+        return 0;
+    }
+    return 1;
+}
+
+// Manifest entry for a month, inserted in order if create is set
+ArchivePartition* getArchivePartition(int month, int create) {
+    int i = archivePartitionCount;
+
+    // New partitions are nearly always the latest month
+    while (i > 0 && archivePartitions[i - 1].month > month) {
+        i--;
+    }
+    if (i > 0 && archivePartitions[i - 1].month == month) {
+        return &archivePartitions[i - 1];
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    if (archivePartitionCount == archivePartitionCapacity) {
+        int capacity = archivePartitionCapacity > 0 ? archivePartitionCapacity * 2 : 16;
+        ArchivePartition* partitions = (ArchivePartition*)realloc(archivePartitions, capacity * sizeof(ArchivePartition));
+        if (partitions == NULL) {
+            return NULL;
+        }
+        archivePartitions = partitions;
+        archivePartitionCapacity = capacity;
+    }
+    memmove(&archivePartitions[i + 1], &archivePartitions[i], (archivePartitionCount - i) * sizeof(ArchivePartition));
+    archivePartitionCount++;
+
+    ArchivePartition* partition = &archivePartitions[i];
+    partition->month = month;
+    partition->size = 0;
+    partition->records = 0;
+    partition->minCheckInDay = INT_MAX;
+    partition->maxCheckOutDay = INT_MIN;
+    return partition;
+}
+
+// Block collecting records for a month, reusing one that has been written out
+ArchiveBlock* getArchiveBlock(int month) {
+    ArchiveBlock* empty = NULL;
+    int i;
+
+    for (i = 0; i < archiveBlockCount; i++) {
+        if (archiveBlocks[i].header.records > 0 && archiveBlocks[i].month == month) {
+            return &archiveBlocks[i];
+        }
+        if (archiveBlocks[i].header.records == 0 && empty == NULL) {
+            empty = &archiveBlocks[i];
+        }
+    }
+
+    if (empty == NULL) {
+        ArchiveBlock* blocks = (ArchiveBlock*)realloc(archiveBlocks, (archiveBlockCount + 1) * sizeof(ArchiveBlock));
+        if (blocks == NULL) {
+            return NULL;
+        }
+        archiveBlocks = blocks;
+        empty = &archiveBlocks[archiveBlockCount];
+        empty->capacity = ARCHIVE_BLOCK_RECORDS * 16;
+        empty->data = (unsigned char*)malloc(empty->capacity);
+        empty->stringOffsets = (unsigned int*)malloc(2 * ARCHIVE_BLOCK_RECORDS * sizeof(unsigned int));
+        empty->dictionary = (int*)malloc(ARCHIVE_DICTIONARY_SLOTS * sizeof(int));
+        if (empty->data == NULL || empty->stringOffsets == NULL || empty->dictionary == NULL) {
+            free(empty->data);
+            free(empty->stringOffsets);
+            free(empty->dictionary);
+            return NULL;
+        }
+        archiveBlockCount++;
+        resetArchiveBlock(empty);
+    }
+    empty->month = month;
+    return empty;
+}
+
+// Append a block to its partition file and fsync it. The manifest is not
+// touched, so the block only counts once commitArchive saves it. A block that
+// could not be written keeps its records for the next try.
+int writeArchiveBlock(ArchiveBlock* block) {
+    char path[ARCHIVE_PATH_LEN];
+    int success = 0;
+
+    if (block->header.records == 0) {
+        return 1;
+    }
+    ArchivePartition* partition = getArchivePartition(block->month, 1);
+    if (partition == NULL) {
+        return 0;
+    }
+
+    // Bytes past the committed size are an unfinished write and get overwritten
+    archivePartitionPath(block->month, path);
+    FILE* file = fopen(path, partition->size > 0 ? "r+b" : "wb");
+    if (file != NULL) {
+        block->header.checksum = snapshotChecksum(2166136261u, block->data, block->header.size);
+        success = fseek(file, (long)partition->size, SEEK_SET) == 0 &&
+                  fwrite(&block->header, sizeof(ArchiveBlockHeader), 1, file) == 1 &&
+                  fwrite(block->data, 1, block->header.size, file) == block->header.size &&
+                  fflush(file) == 0 && fsync(fileno(file)) == 0;
+        fclose(file);
+    }
+    if (!success) {
+        return 0;
+    }
+
+    partition->size += sizeof(ArchiveBlockHeader) + block->header.size;
+    partition->records += block->header.records;
+    if (block->header.minCheckInDay < partition->minCheckInDay) {
+        partition->minCheckInDay = block->header.minCheckInDay;
+    }
+    if (block->header.maxCheckOutDay > partition->maxCheckOutDay) {
+        partition->maxCheckOutDay = block->header.maxCheckOutDay;
+    }
+    metricsAdd(COUNTER_ARCHIVE_BYTES, sizeof(ArchiveBlockHeader) + block->header.size);
+    resetArchiveBlock(block);
+    return 1;
+}
+
+void resetArchiveBlock(ArchiveBlock* block) {
+    memset(&block->header, 0, sizeof(block->header));
+    block->header.magic = ARCHIVE_MAGIC;
+    block->header.minCheckInDay = INT_MAX;
+    block->header.maxCheckOutDay = INT_MIN;
+    block->previousCheckOutDay = 0;
+    block->stringCount = 0;
+    memset(block->dictionary, 0, ARCHIVE_DICTIONARY_SLOTS * sizeof(int));
+}
+
+// Store a string as its dictionary index, adding it on first use
+void packArchiveString(ArchiveBlock* block, const char text[]) {
+    unsigned int slot = hashUsername(text) & (ARCHIVE_DICTIONARY_SLOTS - 1);
+    unsigned char* out = block->data + block->header.size;
+    size_t length = strlen(text) + 1;
+
+    while (block->dictionary[slot] != 0) {
+        int index = block->dictionary[slot] - 1;
+        if (strcmp((const char*)block->data + block->stringOffsets[index], text) == 0) {
+            out = putVarint(out, (unsigned int)index);
+            block->header.size = (unsigned int)(out - block->data);
+            return;
+        }
+        slot = (slot + 1) & (ARCHIVE_DICTIONARY_SLOTS - 1);
+    }
+
+    out = putVarint(out, (unsigned int)block->stringCount);
+    block->stringOffsets[block->stringCount] = (unsigned int)(out - block->data);
+    memcpy(out, text, length);
+    block->dictionary[slot] = ++block->stringCount;
+    block->header.size = (unsigned int)(out + length - block->data);
+}
+
+// Decode a block and visit its records that touch [fromDay, toDay). Returns 0
+// if the block is malformed.
+int unpackArchiveBlock(const ArchiveBlockHeader* header, const unsigned char* data, int fromDay, int toDay,
+                       ArchiveVisitor visitor, void* context) {
+    const unsigned char* in = data;
+    const unsigned char* end = data + header->size;
+    const char** strings = (const char**)malloc(2 * ARCHIVE_BLOCK_RECORDS * sizeof(const char*));
+    unsigned int values[6];
+    unsigned int index;
+    ArchiveRecord record;
+    int stringCount = 0;
+    int checkOutDay = 0;
+    unsigned int i;
+    int j, k;
+
+    if (strings == NULL) {
+        return 0;
+    }
+    for (i = 0; i < header->records; i++) {
+        for (j = 0; j < 6; j++) {
+            if (!getVarint(&in, end, &values[j])) {
+                free(strings);
+                return 0;
+            }
+        }
+        // Username, then room type
+        for (k = 0; k < 2; k++) {
+            size_t limit = k == 0 ? MAX_NAME_LEN : MAX_ROOM_TYPE_LEN;
+            if (!getVarint(&in, end, &index) || index > (unsigned int)stringCount) {
+                free(strings);
+                return 0;
+            }
+            if (index == (unsigned int)stringCount) {
+                const unsigned char* terminator = (const unsigned char*)memchr(in, '\0', end - in);
+                if (terminator == NULL || (size_t)(terminator - in) >= limit) {
+                    free(strings);
+                    return 0;
+                }
+                strings[stringCount++] = (const char*)in;
+                in = terminator + 1;
+            }
+            strcpy(k == 0 ? record.username : record.roomType, strings[index]);
+        }
+
+        checkOutDay += unzigzag(values[0]);
+        record.checkOutDay = checkOutDay;
+        record.checkInDay = checkOutDay - unzigzag(values[1]);
+        record.checkInMinute = (int)values[2];
+        record.checkOutMinute = (int)values[3];
+        record.roomNumber = (int)values[4];
+        record.pricePerNight = values[5] / 100.0;
+        if (record.checkInDay < toDay && record.checkOutDay >= fromDay) {
+            visitor(&record, context);
+        }
+    }
+
+    free(strings);
+    return 1;
+}
+
+void archivePartitionPath(int month, char path[]) {
+    snprintf(path, ARCHIVE_PATH_LEN, "%s.%04d-%02d.arc", archivePrefix, month / 12, month % 12 + 1);
+}
+
+int dayToMonth(int day) {
+    int year, month, dayOfMonth;
+    civilFromDays(day, &year, &month, &dayOfMonth);
+    return year * 12 + month - 1;
+}
+
+int monthStartDay(int month) {
+    return daysFromCivil(month / 12, month % 12 + 1, 1);
+}
+
+// Parse YYYY-MM
+int parseMonth(const char text[], int* month) {
+    int i;
+
+    for (i = 0; i < 7; i++) {
+        if (i == 4 ? text[i] != '-' : (text[i] < '0' || text[i] > '9')) {
+            return 0;
+        }
+    }
+    int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10 + (text[3] - '0');
+    int monthOfYear = (text[5] - '0') * 10 + (text[6] - '0');
+    if (text[7] != '\0' || monthOfYear < 1 || monthOfYear > 12) {
+        return 0;
+    }
+    *month = year * 12 + monthOfYear - 1;
+    return 1;
+}
+
+void formatMonth(int month, char text[]) {
+    sprintf(text, "%04d-%02d", month / 12, month % 12 + 1);
+}
+
+unsigned char* putVarint(unsigned char* out, unsigned int value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+// Returns 0 if the varint runs past end or is too long
+int getVarint(const unsigned char** in, const unsigned char* end, unsigned int* value) {
+    unsigned int result = 0;
+    int shift;
+
+    for (shift = 0; shift < 35 && *in < end; shift += 7) {
+        unsigned char byte = *(*in)++;
+        result |= (unsigned int)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Small negative numbers stay small: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+unsigned int zigzag(int value) {
+    return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+}
+
+int unzigzag(unsigned int value) {
+    return (int)(value >> 1) ^ -(int)(value & 1);
+}
@@ -0,0 +1,122 @@
+#ifndef HOTEL_ARCHIVE_H
+#define HOTEL_ARCHIVE_H
+
+// Cold tier for reservations that have checked out. Expiry moves them out of
+// the in-memory structures into append-only partition files, one per month
+// of check-out (<prefix>.YYYY-MM.arc). <prefix>.arc lists the partitions and
+// how many bytes of each are committed; anything past that is the tail of a
+// write that never finished and is ignored.
+//
+// A partition is a run of blocks: a header, then the block's records packed
+// as varints, day numbers as deltas, and names and room types as indexes
+// into a dictionary that each block builds up as it goes (a new string is
+// stored once, NUL-terminated, right after its index). A record takes
+// about 15 bytes against well over 100 for a live Reservation. Scans read
+// one block at a time and skip blocks and partitions by their date bounds,
+// so reports never load the archive into memory.
+
+#include "hotelEngine.h"
+
+#define ARCHIVE_PREFIX "reservations"
+#define ARCHIVE_MAGIC 0x43524148u          // "HARC" in a little-endian file
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_BLOCK_RECORDS 4096         // Most records packed into one block
+#define ARCHIVE_DICTIONARY_SLOTS 16384     // Power of 2, twice the strings a block can hold
+#define ARCHIVE_MAX_RECORD_LEN (10 * 5 + MAX_NAME_LEN + MAX_ROOM_TYPE_LEN)
+#define ARCHIVE_PATH_LEN (MAX_PATH_LEN + 24)  // Prefix plus ".YYYY-MM.arc" or ".arc.tmp"
+
+// Manifest entry for one month of check-outs
+typedef struct ArchivePartition {
+    int month;              // year * 12 + month - 1
+    unsigned int size;      // Committed bytes of the partition file
+    unsigned int records;
+    int minCheckInDay;      // Bounds over every record in the partition
+    int maxCheckOutDay;
+} ArchivePartition;
+
+typedef struct ArchiveManifestHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int partitionCount;
+    unsigned int checksum;  // Over the partition entries
+    int archivedThroughDay; // Every reservation checking out before this
+    int archivedThroughMinute;  // day and minute has been archived
+} ArchiveManifestHeader;
+
+typedef struct ArchiveBlockHeader {
+    unsigned int magic;
+    unsigned int records;
+    unsigned int size;      // Bytes of packed records after the header
+    unsigned int checksum;
+    int minCheckInDay;
+    int maxCheckOutDay;
+} ArchiveBlockHeader;
+
+// Block being filled for one partition, in the layout it is written in
+typedef struct ArchiveBlock {
+    int month;
+    ArchiveBlockHeader header;
+    unsigned char* data;
+    size_t capacity;
+    int previousCheckOutDay;
+    int stringCount;
+    unsigned int* stringOffsets;  // Where each dictionary string starts in data
+    int* dictionary;              // Hash of string to index + 1, 0 when empty
+} ArchiveBlock;
+
+// One archived stay as a scan hands it out
+typedef struct ArchiveRecord {
+    char username[MAX_NAME_LEN];
+    char roomType[MAX_ROOM_TYPE_LEN];
+    int roomNumber;
+    int checkInDay;
+    int checkInMinute;
+    int checkOutDay;
+    int checkOutMinute;
+    double pricePerNight;   // Rate of the room's type when the stay ended
+} ArchiveRecord;
+
+// Figures for one calendar month. Nights and revenue count in the month the
+// night falls in, stays in the month they checked out.
+typedef struct ArchiveMonthReport {
+    int month;
+    int stays;
+    int roomNights;
+    double revenue;
+} ArchiveMonthReport;
+
+// Called for each record of a scan
+typedef void (*ArchiveVisitor)(const ArchiveRecord* record, void* context);
+
+extern char archivePrefix[MAX_PATH_LEN];
+extern ArchivePartition* archivePartitions;  // Sorted by month
+extern int archivePartitionCount;
+extern int archivedThroughDay;
+extern int archivedThroughMinute;
+extern int archiveCommitPending;
+
+void openArchive();
+void closeArchive();
+void removeArchiveFiles();
+int archiveReservation(Reservation* reservation);
+int commitArchive(int throughDay, int throughMinute);
+int scanArchive(int fromDay, int toDay, ArchiveVisitor visitor, void* context);
+int archiveReport(int firstMonth, int monthCount, ArchiveMonthReport report[]);
+
+int loadArchiveManifest();
+int saveArchiveManifest();
+ArchivePartition* getArchivePartition(int month, int create);
+ArchiveBlock* getArchiveBlock(int month);
+int writeArchiveBlock(ArchiveBlock* block);
+void resetArchiveBlock(ArchiveBlock* block);
+void packArchiveString(ArchiveBlock* block, const char text[]);
+int unpackArchiveBlock(const ArchiveBlockHeader* header, const unsigned char* data, int fromDay, int toDay,
+                       ArchiveVisitor visitor, void* context);
+void addToArchiveReport(const ArchiveRecord* record, void* context);
+void archivePartitionPath(int month, char path[]);
+int dayToMonth(int day);
+int monthStartDay(int month);
+int parseMonth(const char text[], int* month);
+void formatMonth(int month, char text[]);
+
+#endif
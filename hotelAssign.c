@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "hotelEngine.h"
+#include "hotelMetrics.h"
+#include "hotelAssign.h"
+
+// Book the room of a type that the stay fits most tightly. On success
+// roomNumber holds the room assigned; the booking is left unlocked.
+HotelStatus hotelBookBestFit(char username[], char roomType[], int checkInDay, int checkInMinute,
+                             int checkOutDay, int checkOutMinute, int* roomNumber) {
+    unsigned long long start = metricsClock();
+    HotelStatus status = HOTEL_OK;
+
+    *roomNumber = 0;
+    if (findRoomType(roomType) < 0) {
+        status = HOTEL_ERR_INVALID_ROOM;
+    } else if (compareDateTime(checkInDay, checkInMinute, checkOutDay, checkOutMinute) >= 0) {
+        status = HOTEL_ERR_INVALID_DATES;
+    } else {
+        *roomNumber = findBestFitRoom(roomType, checkInDay, checkOutDay);
+        if (*roomNumber == 0) {
+            status = HOTEL_ERR_ROOM_UNAVAILABLE;
+        } else {
+            commitBooking(username, *roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute, 0);
+            journalCommit();
+        }
+    }
+
+    metricsRecord(METRIC_BEST_FIT, start);
+    return status;
+}
+
+// Move unlocked bookings that check in after fromDay/fromMinute between the
+// rooms of their type ("all" for every type) where that leaves fewer orphan
+// days. Each type is rearranged as a whole or not at all, and its moves are
+// journaled as one group.
+HotelStatus hotelReoptimize(char roomType[], int fromDay, int fromMinute, ReoptimizeResult* result) {
+    unsigned long long start = metricsClock();
+    HotelStatus status = HOTEL_OK;
+    int all = strcmp(roomType, "all") == 0;
+    int typeId = all ? 0 : findRoomType(roomType);
+    int lastType = all ? roomTypeCount - 1 : typeId;
+
+    memset(result, 0, sizeof(ReoptimizeResult));
+    if (typeId < 0) {
+        return HOTEL_ERR_INVALID_ROOM;
+    }
+
+    for (; typeId <= lastType && status == HOTEL_OK; typeId++) {
+        if (!reoptimizeType(typeId, fromDay, fromMinute, result)) {
+            status = HOTEL_ERR_IO;
+        }
+    }
+    journalCommit();
+
+    metricsRecord(METRIC_REOPTIMIZE, start);
+    return status;
+}
+
+// Room number of the best fitting free room of a type, or 0 if none is free
+int findBestFitRoom(const char roomType[], int checkInDay, int checkOutDay) {
+    int typeId = findRoomType(roomType);
+    int slot = typeId >= 0 ? bestFitSlot(typeId, checkInDay, checkOutDay) : -1;
+
+    return slot >= 0 ? rooms[slot].roomNumber : 0;
+}
+
+// Free days from fromDay on that sit in gaps of at most FIT_ORPHAN_DAYS
+// between two stays in the rooms of a type
+int countOrphanDays(int typeId, int fromDay) {
+    RoomType* type = &roomTypes[typeId];
+    int total = 0;
+    int i, j;
+
+    for (i = 0; i < type->roomCount; i++) {
+        RoomBookings* bookings = &roomBookings[type->roomSlots[i]];
+
+        for (j = 1; j < bookings->count; j++) {
+            int first = bookings->items[j - 1]->checkOutDay + 1;
+            int last = bookings->items[j]->checkInDay - 1;
+
+            if (last - first + 1 > FIT_ORPHAN_DAYS) {
+                continue;
+            }
+            if (first < fromDay) {
+                first = fromDay;
+            }
+            if (last >= first) {
+                total += last - first + 1;
+            }
+        }
+    }
+    return total;
+}
+
+// Slot of the free room of a type that the stay fits most tightly, or -1 if
+// every room is taken. Ties go to the type's first room.
+int bestFitSlot(int typeId, int checkInDay, int checkOutDay) {
+    unsigned long long mask[OCCUPANCY_WORDS];
+    int firstWord, lastWord;
+    int inHorizon = buildOccupancyMask(checkInDay, checkOutDay, mask, &firstWord, &lastWord);
+    int first = checkInDay - occupancyBaseDay;
+    int last = checkOutDay - occupancyBaseDay;
+    // With FIT_OPEN_DAYS either side inside the horizon too, the bitmaps
+    // alone size up the gap and the reservations are never read
+    int onBitmap = inHorizon && first >= FIT_OPEN_DAYS && last + FIT_OPEN_DAYS < OCCUPANCY_DAYS;
+    RoomType* type = &roomTypes[typeId];
+    int bestSlot = -1;
+    int bestFit = INT_MAX;
+    int i, word;
+
+    for (i = 0; i < type->roomCount && bestFit > 0; i++) {
+        int slot = type->roomSlots[i];
+        RoomBookings* bookings = &roomBookings[slot];
+        int fit;
+
+        // The bitmaps turn most taken rooms away without a search
+        if (inHorizon && bookings->count > 0) {
+            unsigned long long clash = 0;
+            for (word = firstWord; word <= lastWord; word++) {
+                clash |= bookings->occupancy[word] & mask[word];
+            }
+            if (clash != 0) {
+                continue;
+            }
+        }
+
+        if (onBitmap) {
+            fit = freeDaysBefore(bookings->occupancy, first - 1, FIT_OPEN_DAYS) +
+                  freeDaysAfter(bookings->occupancy, last + 1, FIT_OPEN_DAYS);
+        } else {
+            fit = gapFit(bookings, checkInDay, checkOutDay);
+        }
+        if (fit >= 0 && fit < bestFit) {
+            bestFit = fit;
+            bestSlot = slot;
+        }
+    }
+    return bestSlot;
+}
+
+// How tightly a stay fills the free gap around it in a room: the free days
+// it leaves before and after, each counted up to FIT_OPEN_DAYS. 0 is a
+// perfect fit and -1 means the room is taken.
+int gapFit(RoomBookings* bookings, int checkInDay, int checkOutDay) {
+    int pos = findBookingPosition(bookings, checkOutDay);
+    int before = FIT_OPEN_DAYS;
+    int after = FIT_OPEN_DAYS;
+
+    // Stays in a room never overlap, so only the last one starting by the
+    // check-out can clash, and the one after it is the next stay
+    if (pos > 0) {
+        int lastTaken = bookings->items[pos - 1]->checkOutDay;
+        if (checkInDay <= lastTaken) {
+            return -1;
+        }
+        before = checkInDay - lastTaken - 1;
+    }
+    if (pos < bookings->count) {
+        after = bookings->items[pos]->checkInDay - checkOutDay - 1;
+    }
+
+    return (before < FIT_OPEN_DAYS ? before : FIT_OPEN_DAYS) + (after < FIT_OPEN_DAYS ? after : FIT_OPEN_DAYS);
+}
+
+// Clear bits of a bitmap from position down, at most limit of them. The
+// caller keeps position - limit + 1 inside the bitmap.
+int freeDaysBefore(const unsigned long long occupancy[], int position, int limit) {
+    int count = 0;
+
+    while (count < limit) {
+        int bit = position % 64;
+        unsigned long long taken = occupancy[position / 64] & (bit == 63 ? ~0ULL : (1ULL << (bit + 1)) - 1);
+        if (taken != 0) {
+            count += bit - highestBit(taken);
+            return count < limit ? count : limit;
+        }
+        count += bit + 1;
+        position -= bit + 1;
+    }
+    return limit;
+}
+
+// Clear bits of a bitmap from position up, at most limit of them. The
+// caller keeps position + limit - 1 inside the bitmap.
+int freeDaysAfter(const unsigned long long occupancy[], int position, int limit) {
+    int count = 0;
+
+    while (count < limit) {
+        int bit = position % 64;
+        unsigned long long taken = occupancy[position / 64] & (~0ULL << bit);
+        if (taken != 0) {
+            count += lowestBit(taken) - bit;
+            return count < limit ? count : limit;
+        }
+        count += 64 - bit;
+        position += 64 - bit;
+    }
+    return limit;
+}
+
+// Take one type's movable bookings out of their rooms and place them again
+// in check-in order, each in its best fitting room. The new layout is kept
+// only if every booking found a room and fewer orphan days are left.
+// Returns 0 if memory ran out, with nothing changed.
+int reoptimizeType(int typeId, int fromDay, int fromMinute, ReoptimizeResult* result) {
+    RoomType* type = &roomTypes[typeId];
+    Reservation** moving;
+    int* fromRooms;
+    int orphanDays = countOrphanDays(typeId, fromDay);
+    int count = 0;
+    int placed = 0;
+    int moves = 0;
+    int i, j;
+
+    result->orphanDaysBefore += orphanDays;
+    for (i = 0; i < type->roomCount; i++) {
+        RoomBookings* bookings = &roomBookings[type->roomSlots[i]];
+        for (j = 0; j < bookings->count; j++) {
+            count += isMovable(bookings->items[j], fromDay, fromMinute);
+        }
+    }
+    if (count == 0) {
+        result->orphanDaysAfter += orphanDays;
+        return 1;
+    }
+
+    moving = (Reservation**)malloc(count * sizeof(Reservation*));
+    fromRooms = (int*)malloc(count * sizeof(int));
+    if (moving == NULL || fromRooms == NULL) {
+        free(moving);
+        free(fromRooms);
+        result->orphanDaysAfter += orphanDays;
+        return 0;
+    }
+
+    count = 0;
+    for (i = 0; i < type->roomCount; i++) {
+        RoomBookings* bookings = &roomBookings[type->roomSlots[i]];
+        for (j = 0; j < bookings->count; j++) {
+            if (isMovable(bookings->items[j], fromDay, fromMinute)) {
+                moving[count++] = bookings->items[j];
+            }
+        }
+    }
+    for (i = 0; i < count; i++) {
+        unindexReservation(moving[i]);
+    }
+    qsort(moving, count, sizeof(Reservation*), compareCheckIn);
+    for (i = 0; i < count; i++) {
+        fromRooms[i] = moving[i]->roomNumber;
+    }
+
+    // Bookings going in check-in order each take the room whose last stay
+    // ended closest before, which packs the stays back to back
+    for (i = 0; i < count; i++) {
+        int slot = bestFitSlot(typeId, moving[i]->checkInDay, moving[i]->checkOutDay);
+        if (slot < 0) {
+            break;
+        }
+        moving[i]->roomNumber = rooms[slot].roomNumber;
+        indexReservation(moving[i]);
+        placed++;
+    }
+
+    int orphanDaysAfter = placed == count ? countOrphanDays(typeId, fromDay) : orphanDays;
+    if (orphanDaysAfter >= orphanDays) {
+        // Put every booking back where it was
+        for (i = 0; i < placed; i++) {
+            unindexReservation(moving[i]);
+        }
+        for (i = 0; i < count; i++) {
+            moving[i]->roomNumber = fromRooms[i];
+            indexReservation(moving[i]);
+        }
+        orphanDaysAfter = orphanDays;
+    } else {
+        for (i = 0; i < count; i++) {
+            moves += moving[i]->roomNumber != fromRooms[i];
+        }
+
+        // Replay applies the moves one at a time, so they go in as a group
+        journalRecord("BEGIN_GROUP:%d", moves);
+        for (i = 0; i < count; i++) {
+            if (moving[i]->roomNumber != fromRooms[i]) {
+                updateReservationRow(moving[i]);
+                journalRecord("MOVE_RESERVATION:%s:%d:%d:%d:%d:%d:%d", moving[i]->username, fromRooms[i],
+                              moving[i]->checkInDay, moving[i]->checkInMinute, moving[i]->checkOutDay,
+                              moving[i]->checkOutMinute, moving[i]->roomNumber);
+            }
+        }
+        journalRecord("END_GROUP");
+        metricsAdd(COUNTER_REASSIGNED, moves);
+    }
+
+    result->candidates += count;
+    result->moved += moves;
+    result->orphanDaysAfter += orphanDaysAfter;
+    free(moving);
+    free(fromRooms);
+    return 1;
+}
+
+// Bookings the engine placed itself that have not checked in by fromDay/fromMinute
+int isMovable(Reservation* reservation, int fromDay, int fromMinute) {
+    return !reservation->locked &&
+           compareDateTime(reservation->checkInDay, reservation->checkInMinute, fromDay, fromMinute) > 0;
+}
+
+// Order by check-in, then check-out and room, so every platform sorts alike
+int compareCheckIn(const void* a, const void* b) {
+    const Reservation* x = *(const Reservation* const*)a;
+    const Reservation* y = *(const Reservation* const*)b;
+    int order = compareDateTime(x->checkInDay, x->checkInMinute, y->checkInDay, y->checkInMinute);
+
+    if (order == 0) {
+        order = compareDateTime(x->checkOutDay, x->checkOutMinute, y->checkOutDay, y->checkOutMinute);
+    }
+    if (order == 0) {
+        order = (x->roomNumber > y->roomNumber) - (x->roomNumber < y->roomNumber);
+    }
+    return order;
+}
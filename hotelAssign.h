@@ -0,0 +1,42 @@
+#ifndef HOTEL_ASSIGN_H
+#define HOTEL_ASSIGN_H
+
+// Room assignment for guests who only ask for a room type. The engine gives
+// them the free room whose gap between stays the booking fills most
+// tightly (best fit), so short gaps get used up and long runs stay whole for
+// long stays. Such bookings are not locked to their room: a re-optimization
+// pass may later move the ones that have not checked in yet between rooms of
+// their type, to close up gaps too short to sell.
+//
+// A stay's gaps are read off the room's occupancy bitmap a word at a time,
+// or past the horizon found as its neighbours in the room's index, which is
+// sorted by check-in.
+
+#include "hotelEngine.h"
+
+#define FIT_OPEN_DAYS 28   // A free run at least this long counts as open calendar
+#define FIT_ORPHAN_DAYS 3  // Free days between two stays too few to sell
+
+// What one re-optimization pass did
+typedef struct ReoptimizeResult {
+    int candidates;        // Unlocked bookings that had not checked in
+    int moved;
+    int orphanDaysBefore;  // Free days in gaps of at most FIT_ORPHAN_DAYS
+    int orphanDaysAfter;
+} ReoptimizeResult;
+
+HotelStatus hotelBookBestFit(char username[], char roomType[], int checkInDay, int checkInMinute,
+                             int checkOutDay, int checkOutMinute, int* roomNumber);
+HotelStatus hotelReoptimize(char roomType[], int fromDay, int fromMinute, ReoptimizeResult* result);
+int findBestFitRoom(const char roomType[], int checkInDay, int checkOutDay);
+int countOrphanDays(int typeId, int fromDay);
+
+int bestFitSlot(int typeId, int checkInDay, int checkOutDay);
+int gapFit(RoomBookings* bookings, int checkInDay, int checkOutDay);
+int freeDaysBefore(const unsigned long long occupancy[], int position, int limit);
+int freeDaysAfter(const unsigned long long occupancy[], int position, int limit);
+int reoptimizeType(int typeId, int fromDay, int fromMinute, ReoptimizeResult* result);
+int isMovable(Reservation* reservation, int fromDay, int fromMinute);
+int compareCheckIn(const void* a, const void* b);
+
+#endif
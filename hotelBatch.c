@@ -0,0 +1,469 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelAssign.h"
+#include "hotelCsv.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
+
+// Runs booking engine commands from a file (or standard input), one per line:
+//
+//   USER <name> <password> [admin]       ROOM <number|first-last> <type> <price>
+//   RATE <type> <price>                  nightly rate of every room of the type
+//   BOOK <user> <room|type> <in date> <in time> <out date> <out time>
+//   GROUP <user> <in date> <in time> <out date> <out time> <room|type>...
+//   MODIFY <user> <room> <in date> <in time> <out date> <out time>
+//   CANCEL <user> <room>                 DELUSER <name>
+//   PASSWD <name> <password>             SEARCH <type|all> <in date> <out date>
+//   AVAILABLE <room> <in date> <out date>
+//   EARLIEST <room|type|all> <from date> <nights>   first check-in from the date the stay fits
+//   EXPIRE <date> <time>                 STATS
+//   LIST                                 SAVE
+//   IMPORT <file.csv>                    EXPORT <file.csv>
+//   METRICS [file.json]                  SYNC
+//   PERSIST <strict|relaxed> [window ms]
+//   CHECKPOINT <every records> [every bytes]
+//   REPORT <YYYY-MM> [months]            archived stays, nights and revenue by month
+//   SCAN <from date> <to date> [room] [user]   stays overlapping the dates; room 0 is any
+//   OCCUPANCY <from date> <to date> [type|all] [day|week|month]
+//                                        occupancy, ADR and RevPAR of the nights from..to-1
+//   REOPTIMIZE <type|all> <date> <time>  move unlocked bookings checking in later to close gaps
+//
+// Dates are YYYY-MM-DD and times HH:MM. Lines starting with '#' are comments.
+// BOOK with a room type takes the room of that type the stay fits best and
+// prints the room number. ROOM's price only sets the rate of a type it
+// creates; RATE changes the rate of a known one.
+// Each command prints one result line so runs can be diffed against each other.
+// Mutations are journaled in relaxed mode unless PERSIST says otherwise; SYNC
+// writes whatever is queued and prints the last journal sequence on disk.
+// A snapshot is also saved, silently, whenever the journal has grown by the
+// CHECKPOINT amounts (0 turns a trigger off).
+
+#define MAX_LINE_LEN 512
+#define MAX_ARGS 64
+#define MAX_SEARCH_RESULTS 64
+#define MAX_REPORT_MONTHS 120
+
+int splitLine(char line[], char* args[]);
+int runCommand(int argc, char* args[]);
+void printResult(const char command[], HotelStatus status);
+void printStats();
+void printReservations();
+void printScan(const ReservationFilter* filter);
+int printArchiveReport(int firstMonth, int monthCount);
+int printOccupancy(const char roomType[], int fromDay, int toDay, int byPeriod, ReportPeriod period);
+void printOccupancyLine(const char label[], const OccupancyReport* report);
+void printUsage(const char program[]);
+
+int main(int argc, char* argv[]) {
+    FILE* input = stdin;
+    char line[MAX_LINE_LEN];
+    char* args[MAX_ARGS];
+    int lineNumber = 0;
+    int failures = 0;
+
+    if (argc == 4 && (strcmp(argv[1], "--to-text") == 0 || strcmp(argv[1], "--to-binary") == 0)) {
+        HotelStatus status = hotelConvert(strcmp(argv[1], "--to-text") == 0, argv[2], argv[3]);
+        printResult(argv[1], status);
+        return status == HOTEL_OK ? 0 : 1;
+    }
+    if (argc > 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "-") != 0) {
+        input = fopen(argv[1], "r");
+        if (input == NULL) {
+            fprintf(stderr, "Error: Could not open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    if (argc == 3) {
+        hotelSetDataFiles(argv[2]);
+    }
+
+    hotelSetPersistence(PERSIST_RELAXED, DEFAULT_PERSIST_WINDOW_MS, 0);
+    if (hotelInit() != HOTEL_OK) {
+        fprintf(stderr, "Error: %s\n", hotelStatusMessage(HOTEL_ERR_IO));
+    }
+
+    while (fgets(line, sizeof(line), input) != NULL) {
+        int count;
+
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        count = splitLine(line, args);
+        if (count == 0 || args[0][0] == '#') {
+            continue;
+        }
+
+        if (!runCommand(count, args)) {
+            fprintf(stderr, "Line %d: unknown command or wrong arguments: %s\n", lineNumber, args[0]);
+            failures++;
+        }
+        if (snapshotDue() && !saveData()) {
+            fprintf(stderr, "Line %d: could not write the snapshot\n", lineNumber);
+        }
+    }
+
+    if (input != stdin) {
+        fclose(input);
+    }
+    hotelShutdown();
+    return failures == 0 ? 0 : 1;
+}
+
+// Split a line on whitespace in place. Returns the number of arguments.
+int splitLine(char line[], char* args[]) {
+    int count = 0;
+    char* token = strtok(line, " \t");
+
+    while (token != NULL && count < MAX_ARGS) {
+        args[count++] = token;
+        token = strtok(NULL, " \t");
+    }
+    return count;
+}
+
+// Execute one command. Returns 0 when the command or its arguments are not recognised.
+int runCommand(int argc, char* args[]) {
+    char* command = args[0];
+    int inDay, inMinute, outDay, outMinute;
+    int firstRoom, lastRoom;
+
+    if (strcmp(command, "USER") == 0 && (argc == 3 || argc == 4)) {
+        int isAdmin = argc == 4 && strcmp(args[3], "admin") == 0;
+        printResult(command, hotelRegister(args[1], args[2], isAdmin));
+    } else if (strcmp(command, "ROOM") == 0 && argc == 4) {
+        if (sscanf(args[1], "%d-%d", &firstRoom, &lastRoom) == 2) {
+            printResult(command, hotelCreateRoomRange(firstRoom, lastRoom, args[2], atof(args[3])));
+        } else {
+            printResult(command, hotelCreateRoom(atoi(args[1]), args[2], atof(args[3])));
+        }
+    } else if (strcmp(command, "RATE") == 0 && argc == 3) {
+        printResult(command, hotelSetRoomRate(args[1], atof(args[2])));
+    } else if ((strcmp(command, "BOOK") == 0 || strcmp(command, "MODIFY") == 0) && argc == 7) {
+        if (!parseDateTime(args[3], args[4], &inDay, &inMinute) ||
+            !parseDateTime(args[5], args[6], &outDay, &outMinute)) {
+            return 0;
+        }
+
+        if (command[0] == 'B' && !isdigit((unsigned char)args[2][0])) {
+            int roomNumber;
+            HotelStatus status = hotelBookBestFit(args[1], args[2], inDay, inMinute, outDay, outMinute, &roomNumber);
+            if (status == HOTEL_OK) {
+                printf("BOOK OK %d\n", roomNumber);
+            } else {
+                printResult(command, status);
+            }
+        } else if (command[0] == 'B') {
+            printResult(command, hotelBook(args[1], atoi(args[2]), inDay, inMinute, outDay, outMinute));
+        } else {
+            Reservation* reservation = findUserReservation(args[1], atoi(args[2]));
+            printResult(command, reservation == NULL ? HOTEL_ERR_NOT_FOUND :
+                        hotelModify(reservation, inDay, inMinute, outDay, outMinute));
+        }
+    } else if (strcmp(command, "GROUP") == 0 && argc >= 7) {
+        GroupBooking bookings[MAX_ARGS];
+        int count = argc - 6;
+        int failedIndex, i;
+
+        if (!parseDateTime(args[2], args[3], &inDay, &inMinute) ||
+            !parseDateTime(args[4], args[5], &outDay, &outMinute)) {
+            return 0;
+        }
+
+        for (i = 0; i < count; i++) {
+            GroupBooking* booking = &bookings[i];
+            char* target = args[6 + i];
+
+            // A number names a room, anything else is a room type
+            booking->roomNumber = isdigit((unsigned char)target[0]) ? atoi(target) : 0;
+            snprintf(booking->roomType, sizeof(booking->roomType), "%s", target);
+            booking->checkInDay = inDay;
+            booking->checkInMinute = inMinute;
+            booking->checkOutDay = outDay;
+            booking->checkOutMinute = outMinute;
+        }
+
+        HotelStatus status = hotelBookGroup(args[1], bookings, count, &failedIndex);
+        if (status == HOTEL_OK) {
+            printf("GROUP OK");
+            for (i = 0; i < count; i++) {
+                printf(" %d", bookings[i].roomNumber);
+            }
+            printf("\n");
+        } else if (failedIndex >= 0) {
+            printf("GROUP ERROR %s: %s\n", args[6 + failedIndex], hotelStatusMessage(status));
+        } else {
+            printResult(command, status);
+        }
+    } else if (strcmp(command, "CANCEL") == 0 && argc == 3) {
+        printResult(command, hotelCancel(args[1], atoi(args[2])));
+    } else if (strcmp(command, "DELUSER") == 0 && argc == 2) {
+        printResult(command, hotelDeleteUser(args[1]));
+    } else if (strcmp(command, "PASSWD") == 0 && argc == 3) {
+        printResult(command, hotelChangePassword(args[1], args[2]));
+    } else if (strcmp(command, "SEARCH") == 0 && argc == 4) {
+        int roomNumbers[MAX_SEARCH_RESULTS];
+        int found, i;
+
+        if (!parseDateTime(args[2], NULL, &inDay, NULL) || !parseDateTime(args[3], NULL, &outDay, NULL)) {
+            return 0;
+        }
+
+        found = searchRooms(args[1], inDay, outDay, roomNumbers, MAX_SEARCH_RESULTS);
+        printf("SEARCH %d", found);
+        for (i = 0; i < found; i++) {
+            printf(" %d", roomNumbers[i]);
+        }
+        printf("\n");
+    } else if (strcmp(command, "AVAILABLE") == 0 && argc == 4) {
+        if (!parseDateTime(args[2], NULL, &inDay, NULL) || !parseDateTime(args[3], NULL, &outDay, NULL)) {
+            return 0;
+        }
+        printf("AVAILABLE %s\n", isRoomAvailableForDates(atoi(args[1]), inDay, outDay) ? "yes" : "no");
+    } else if (strcmp(command, "EARLIEST") == 0 && argc == 4) {
+        int nights = atoi(args[3]);
+        int roomNumber = isdigit((unsigned char)args[1][0]) ? atoi(args[1]) : 0;
+        char date[11];
+
+        if (!parseDateTime(args[2], NULL, &inDay, NULL)) {
+            return 0;
+        }
+        if (nights < 1 || nights > OCCUPANCY_DAYS) {
+            printResult(command, HOTEL_ERR_INVALID_DATES);
+            return 1;
+        }
+        roomNumber = findEarliestSlot(args[1], roomNumber, inDay, nights, &inDay);
+        if (roomNumber == 0) {
+            printResult(command, HOTEL_ERR_INVALID_ROOM);
+        } else {
+            dayToDate(inDay, date);
+            printf("EARLIEST %s %d\n", date, roomNumber);
+        }
+    } else if (strcmp(command, "EXPIRE") == 0 && argc == 3) {
+        int before = hotelStats.totalReservations;
+
+        if (!parseDateTime(args[1], args[2], &inDay, &inMinute)) {
+            return 0;
+        }
+        int success = expireReservations(inDay, inMinute);
+        advanceOccupancyHorizon(inDay);
+        if (success) {
+            printf("EXPIRE %d\n", before - hotelStats.totalReservations);
+        } else {
+            printResult(command, HOTEL_ERR_IO);
+        }
+    } else if (strcmp(command, "STATS") == 0 && argc == 1) {
+        printStats();
+    } else if (strcmp(command, "LIST") == 0 && argc == 1) {
+        printReservations();
+    } else if (strcmp(command, "SCAN") == 0 && argc >= 3 && argc <= 5) {
+        ReservationFilter filter;
+        User* user = argc == 5 ? findUser(args[4]) : NULL;
+
+        if (!parseDateTime(args[1], NULL, &filter.fromDay, NULL) || !parseDateTime(args[2], NULL, &filter.toDay, NULL)) {
+            return 0;
+        }
+        filter.roomNumber = argc >= 4 ? atoi(args[3]) : 0;
+        filter.userId = user != NULL ? user->id : 0;
+        if (argc == 5 && user == NULL) {
+            printResult(command, HOTEL_ERR_NOT_FOUND);
+        } else {
+            printScan(&filter);
+        }
+    } else if (strcmp(command, "IMPORT") == 0 && argc == 2) {
+        CsvImportResult result;
+        HotelStatus status = hotelImportCsv(args[1], &result);
+        if (status != HOTEL_OK) {
+            printResult(command, status);
+        } else {
+            printf("IMPORT rooms=%d users=%d reservations=%d expired=%d rejected=%d\n",
+                   result.rooms, result.users, result.reservations, result.expired, result.rejected);
+        }
+    } else if (strcmp(command, "EXPORT") == 0 && argc == 2) {
+        printResult(command, hotelExportCsv(args[1]));
+    } else if (strcmp(command, "METRICS") == 0 && argc <= 2) {
+        printResult(command, metricsDumpJson(argc == 2 ? args[1] : METRICS_FILE) ? HOTEL_OK : HOTEL_ERR_IO);
+    } else if (strcmp(command, "PERSIST") == 0 && (argc == 2 || argc == 3) &&
+               (strcmp(args[1], "strict") == 0 || strcmp(args[1], "relaxed") == 0)) {
+        hotelSetPersistence(args[1][0] == 's' ? PERSIST_STRICT : PERSIST_RELAXED,
+                            argc == 3 ? atoi(args[2]) : DEFAULT_PERSIST_WINDOW_MS, 0);
+        printResult(command, HOTEL_OK);
+    } else if (strcmp(command, "CHECKPOINT") == 0 && (argc == 2 || argc == 3)) {
+        hotelSetSnapshotTriggers(strtoull(args[1], NULL, 10), argc == 3 ? strtoull(args[2], NULL, 10) : 0);
+        printResult(command, HOTEL_OK);
+    } else if (strcmp(command, "REPORT") == 0 && (argc == 2 || argc == 3)) {
+        int firstMonth;
+        int monthCount = argc == 3 ? atoi(args[2]) : 1;
+
+        if (!parseMonth(args[1], &firstMonth) || monthCount < 1 || monthCount > MAX_REPORT_MONTHS) {
+            return 0;
+        }
+        if (!printArchiveReport(firstMonth, monthCount)) {
+            printResult(command, HOTEL_ERR_IO);
+        }
+    } else if (strcmp(command, "OCCUPANCY") == 0 && argc >= 3 && argc <= 5) {
+        ReportPeriod period = REPORT_DAY;
+
+        if (!parseDateTime(args[1], NULL, &inDay, NULL) || !parseDateTime(args[2], NULL, &outDay, NULL) ||
+            (argc == 5 && !parseReportPeriod(args[4], &period))) {
+            return 0;
+        }
+        if (!printOccupancy(argc >= 4 ? args[3] : "all", inDay, outDay, argc == 5, period)) {
+            printResult(command, HOTEL_ERR_INVALID_DATES);
+        }
+    } else if (strcmp(command, "REOPTIMIZE") == 0 && argc == 4) {
+        ReoptimizeResult result;
+        HotelStatus status;
+
+        if (!parseDateTime(args[2], args[3], &inDay, &inMinute)) {
+            return 0;
+        }
+        status = hotelReoptimize(args[1], inDay, inMinute, &result);
+        if (status != HOTEL_OK) {
+            printResult(command, status);
+        } else {
+            printf("REOPTIMIZE candidates=%d moved=%d orphan_days=%d->%d\n", result.candidates, result.moved,
+                   result.orphanDaysBefore, result.orphanDaysAfter);
+        }
+    } else if (strcmp(command, "SYNC") == 0 && argc == 1) {
+        if (flushJournal()) {
+            printf("SYNC OK %llu\n", journalDurableSequence);
+        } else {
+            printResult(command, HOTEL_ERR_IO);
+        }
+    } else if (strcmp(command, "SAVE") == 0 && argc == 1) {
+        printResult(command, hotelSave());
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+void printResult(const char command[], HotelStatus status) {
+    if (status == HOTEL_OK) {
+        printf("%s OK\n", command);
+    } else {
+        printf("%s ERROR %s\n", command, hotelStatusMessage(status));
+    }
+}
+
+void printStats() {
+    int i;
+
+    printf("STATS rooms=%d booked=%d reservations=%d users=%d\n",
+           totalRooms, hotelStats.bookedRooms, hotelStats.totalReservations, userTableCount);
+    for (i = 0; i < hotelStats.typeCount; i++) {
+        RoomTypeStats* type = &hotelStats.types[i];
+        printf("  %s rooms=%d booked=%d reservations=%d\n",
+               roomTypes[i].name, type->rooms, type->bookedRooms, type->reservations);
+    }
+}
+
+void printReservations() {
+    Reservation* current = reservationList;
+
+    while (current != NULL) {
+        printf("  %s room=%d in=%s", current->username, current->roomNumber,
+               formatDateTime(current->checkInDay, current->checkInMinute));
+        printf(" out=%s\n", formatDateTime(current->checkOutDay, current->checkOutMinute));
+        current = current->next;
+    }
+    printf("LIST %d\n", hotelStats.totalReservations);
+}
+
+// Matches come out in the order they were booked
+void printScan(const ReservationFilter* filter) {
+    int count = countReservations(filter);
+    int i;
+
+    Reservation** matches = (Reservation**)malloc((count > 0 ? count : 1) * sizeof(Reservation*));
+    if (matches == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    scanReservations(filter, matches, count);
+    for (i = 0; i < count; i++) {
+        printf("  %s room=%d in=%s", matches[i]->username, matches[i]->roomNumber,
+               formatDateTime(matches[i]->checkInDay, matches[i]->checkInMinute));
+        printf(" out=%s\n", formatDateTime(matches[i]->checkOutDay, matches[i]->checkOutMinute));
+    }
+    printf("SCAN %d\n", count);
+
+    free(matches);
+}
+
+// Occupancy is against the rooms the hotel has now
+int printArchiveReport(int firstMonth, int monthCount) {
+    ArchiveMonthReport report[MAX_REPORT_MONTHS];
+    char month[8];
+    int i;
+
+    if (!archiveReport(firstMonth, monthCount, report)) {
+        return 0;
+    }
+    for (i = 0; i < monthCount; i++) {
+        int roomDays = totalRooms * (monthStartDay(report[i].month + 1) - monthStartDay(report[i].month));
+        formatMonth(report[i].month, month);
+        printf("  %s stays=%d nights=%d revenue=%.2f occupancy=%.1f%%\n", month, report[i].stays,
+               report[i].roomNights, report[i].revenue, roomDays > 0 ? report[i].roomNights * 100.0 / roomDays : 0.0);
+    }
+    printf("REPORT %d\n", monthCount);
+    return 1;
+}
+
+// One line per period, or with no period one per room type and a total.
+// Returns 0 if the type is unknown or the dates are outside the report window.
+int printOccupancy(const char roomType[], int fromDay, int toDay, int byPeriod, ReportPeriod period) {
+    OccupancyReport reports[REPORT_MAX_PERIODS];
+    char label[11];
+    int count = 0;
+    int i;
+
+    if (byPeriod) {
+        count = occupancySeries(roomType, fromDay, toDay, period, reports, REPORT_MAX_PERIODS);
+        for (i = 0; i < count; i++) {
+            dayToDate(reports[i].fromDay, label);
+            printOccupancyLine(label, &reports[i]);
+        }
+    } else if (strcmp(roomType, "all") == 0) {
+        for (i = 0; i < roomTypeCount; i++) {
+            if (roomTypes[i].roomCount > 0 && occupancyReport(roomTypes[i].name, fromDay, toDay, &reports[0])) {
+                printOccupancyLine(roomTypes[i].name, &reports[0]);
+                count++;
+            }
+        }
+        if (!occupancyReport("all", fromDay, toDay, &reports[0])) {
+            return 0;
+        }
+        printOccupancyLine("all", &reports[0]);
+        count++;
+    } else if (occupancyReport(roomType, fromDay, toDay, &reports[0])) {
+        printOccupancyLine(roomType, &reports[0]);
+        count = 1;
+    } else {
+        count = -1;
+    }
+
+    if (count < 0) {
+        return 0;
+    }
+    printf("OCCUPANCY %d\n", count);
+    return 1;
+}
+
+void printOccupancyLine(const char label[], const OccupancyReport* report) {
+    printf("  %s rooms=%d nights=%.0f occupancy=%.1f%% adr=%.2f revpar=%.2f revenue=%.2f\n", label, report->rooms,
+           report->roomNights, report->occupancy, report->adr, report->revpar, report->revenue);
+}
+
+void printUsage(const char program[]) {
+    fprintf(stderr, "Usage: %s [commands.txt|-] [data file prefix]\n", program);
+    fprintf(stderr, "       %s --to-text|--to-binary <input> <output>\n", program);
+}
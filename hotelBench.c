@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelAssign.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
+
+// Benchmark harness: builds a synthetic hotel through the engine API and
+// reports throughput and latency percentiles for each operation.
+//
+//   hotel_bench [rooms] [users] [reservations] [seed]
+
+#define BENCH_PREFIX "hotel_bench"
+#define BENCH_HORIZON_DAYS 730  // Bookings start within two years of today
+#define BENCH_MAX_STAY 7
+#define BENCH_QUERIES 20000
+#define BENCH_LOAD_ROUNDS 5
+#define BENCH_SCAN_ROUNDS 200
+
+typedef struct BenchTimings {
+    const char* name;
+    double* samples;  // Nanoseconds per operation
+    int count;
+    int capacity;
+    int succeeded;
+} BenchTimings;
+
+unsigned long long rngState = 88172645463325252ULL;
+
+unsigned int nextRandom();
+int randomBelow(int limit);
+void beginTimings(BenchTimings* timings, const char* name, int capacity);
+void recordTiming(BenchTimings* timings, unsigned long long start, int succeeded);
+int compareSamples(const void* a, const void* b);
+void reportTimings(BenchTimings* timings);
+void removeBenchFiles();
+
+int main(int argc, char* argv[]) {
+    static char* roomTypes[] = {"Standard", "Deluxe", "Suite"};
+    static double roomPrices[] = {100.0, 150.0, 250.0};
+    int roomCount = argc > 1 ? atoi(argv[1]) : 2000;
+    int userCount = argc > 2 ? atoi(argv[2]) : 1000;
+    int reservationCount = argc > 3 ? atoi(argv[3]) : 50000;
+    int roomNumbers[64];
+    char username[MAX_NAME_LEN];
+    BenchTimings timings = {0};
+    int today, minute;
+    int i;
+
+    if (argc > 4) {
+        rngState = strtoull(argv[4], NULL, 10) | 1;
+    }
+    if (roomCount < 1 || userCount < 1 || reservationCount < 0) {
+        fprintf(stderr, "Usage: %s [rooms] [users] [reservations] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    hotelSetDataFiles(BENCH_PREFIX);
+    hotelSetPersistence(PERSIST_RELAXED, DEFAULT_PERSIST_WINDOW_MS, 0);
+    removeBenchFiles();
+    if (hotelInit() != HOTEL_OK) {
+        fprintf(stderr, "Error: %s\n", hotelStatusMessage(HOTEL_ERR_IO));
+        return 1;
+    }
+    getCurrentDateTime(&today, &minute);
+
+    printf("%d rooms, %d users, %d reservations\n", roomCount, userCount, reservationCount);
+    printf("%-12s %10s %12s %10s %10s %10s %10s %10s\n",
+           "operation", "ops", "ops/sec", "ok", "p50 us", "p90 us", "p99 us", "max us");
+
+    beginTimings(&timings, "create room", roomCount);
+    for (i = 1; i <= roomCount; i++) {
+        int type = randomBelow(3);
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelCreateRoom(i, roomTypes[type], roomPrices[type]) == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "register", userCount);
+    for (i = 0; i < userCount; i++) {
+        snprintf(username, sizeof(username), "guest%d", i);
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelRegister(username, "password", 0) == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    // Random stays; conflicts are part of the workload and count as failures
+    beginTimings(&timings, "book", reservationCount);
+    for (i = 0; i < reservationCount; i++) {
+        int checkInDay = today + 1 + randomBelow(BENCH_HORIZON_DAYS);
+        int checkOutDay = checkInDay + 1 + randomBelow(BENCH_MAX_STAY);
+        int roomNumber = 1 + randomBelow(roomCount);
+        snprintf(username, sizeof(username), "guest%d", randomBelow(userCount));
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start,
+                     hotelBook(username, roomNumber, checkInDay, 14 * 60, checkOutDay, 11 * 60) == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "search", BENCH_QUERIES);
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        char* roomType = randomBelow(4) == 0 ? "all" : roomTypes[randomBelow(3)];
+        int checkInDay = today + 1 + randomBelow(BENCH_HORIZON_DAYS);
+        int checkOutDay = checkInDay + 1 + randomBelow(BENCH_MAX_STAY);
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, searchRooms(roomType, checkInDay, checkOutDay, roomNumbers, 64) > 0);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "available", BENCH_QUERIES);
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        int roomNumber = 1 + randomBelow(roomCount);
+        int checkInDay = today + 1 + randomBelow(BENCH_HORIZON_DAYS);
+        int checkOutDay = checkInDay + 1 + randomBelow(BENCH_MAX_STAY);
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, isRoomAvailableForDates(roomNumber, checkInDay, checkOutDay));
+    }
+    reportTimings(&timings);
+
+    // First check-in a stay of up to two weeks fits, in one room or across a type
+    beginTimings(&timings, "earliest", BENCH_QUERIES);
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        int roomNumber = randomBelow(2) == 0 ? 1 + randomBelow(roomCount) : 0;
+        int fromDay = today + 1 + randomBelow(BENCH_HORIZON_DAYS);
+        int nights = 1 + randomBelow(2 * BENCH_MAX_STAY);
+        int checkInDay;
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, findEarliestSlot(roomTypes[randomBelow(3)], roomNumber, fromDay, nights, &checkInDay) != 0);
+    }
+    reportTimings(&timings);
+
+    // Stays booked by type into the best fitting room, then one pass that
+    // rearranges them from today on
+    beginTimings(&timings, "best fit", BENCH_QUERIES);
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        int checkInDay = today + 1 + randomBelow(BENCH_HORIZON_DAYS);
+        int checkOutDay = checkInDay + 1 + randomBelow(BENCH_MAX_STAY);
+        int roomNumber;
+        snprintf(username, sizeof(username), "guest%d", randomBelow(userCount));
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelBookBestFit(username, roomTypes[randomBelow(3)], checkInDay, 14 * 60,
+                                                       checkOutDay, 11 * 60, &roomNumber) == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "reoptimize", 1);
+    {
+        ReoptimizeResult result;
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelReoptimize("all", today, minute, &result) == HOTEL_OK && result.moved > 0);
+    }
+    reportTimings(&timings);
+
+    // Month-long windows over every room, and a year of one room
+    beginTimings(&timings, "scan dates", BENCH_SCAN_ROUNDS);
+    for (i = 0; i < BENCH_SCAN_ROUNDS; i++) {
+        ReservationFilter filter = { 0, 0, 0, 0 };
+        filter.fromDay = today + randomBelow(BENCH_HORIZON_DAYS);
+        filter.toDay = filter.fromDay + 30;
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, countReservations(&filter) > 0);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "scan room", BENCH_SCAN_ROUNDS);
+    for (i = 0; i < BENCH_SCAN_ROUNDS; i++) {
+        ReservationFilter filter = { 0, 0, 0, 0 };
+        filter.roomNumber = 1 + randomBelow(roomCount);
+        filter.fromDay = today;
+        filter.toDay = today + 365;
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, countReservations(&filter) > 0);
+    }
+    reportTimings(&timings);
+
+    // Occupancy and revenue over random ranges of up to a year
+    beginTimings(&timings, "report", BENCH_QUERIES);
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        OccupancyReport report;
+        int fromDay = today + randomBelow(365);
+        int toDay = fromDay + 1 + randomBelow(365);
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, occupancyReport(randomBelow(4) == 0 ? "all" : roomTypes[randomBelow(3)],
+                                                      fromDay, toDay, &report));
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "save", BENCH_LOAD_ROUNDS);
+    for (i = 0; i < BENCH_LOAD_ROUNDS; i++) {
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelSave() == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    beginTimings(&timings, "load", BENCH_LOAD_ROUNDS);
+    for (i = 0; i < BENCH_LOAD_ROUNDS; i++) {
+        hotelShutdown();
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelInit() == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    // Same data from the text snapshot older installs still have
+    beginTimings(&timings, "load text", BENCH_LOAD_ROUNDS);
+    saveTextSnapshot(textFilePath);
+    remove(snapshotFilePath);
+    for (i = 0; i < BENCH_LOAD_ROUNDS; i++) {
+        hotelShutdown();
+        unsigned long long start = metricsClock();
+        recordTiming(&timings, start, hotelInit() == HOTEL_OK);
+    }
+    reportTimings(&timings);
+
+    // Walk the clock forward one day at a time until every stay has ended
+    beginTimings(&timings, "expire day", BENCH_HORIZON_DAYS + BENCH_MAX_STAY + 1);
+    for (i = 1; i <= BENCH_HORIZON_DAYS + BENCH_MAX_STAY + 1; i++) {
+        int before = hotelStats.totalReservations;
+        unsigned long long start = metricsClock();
+        expireReservations(today + i, minute);
+        advanceOccupancyHorizon(today + i);
+        recordTiming(&timings, start, hotelStats.totalReservations < before);
+    }
+    reportTimings(&timings);
+
+    hotelShutdown();
+    removeBenchFiles();
+    free(timings.samples);
+    return 0;
+}
+
+// xorshift64* keeps runs reproducible for a given seed
+unsigned int nextRandom() {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return (unsigned int)((rngState * 2685821657736338717ULL) >> 32);
+}
+
+int randomBelow(int limit) {
+    return (int)(nextRandom() % (unsigned int)limit);
+}
+
+void beginTimings(BenchTimings* timings, const char* name, int capacity) {
+    if (timings->capacity < capacity) {
+        free(timings->samples);
+        timings->samples = (double*)malloc((capacity > 0 ? capacity : 1) * sizeof(double));
+        if (timings->samples == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        timings->capacity = capacity;
+    }
+    timings->name = name;
+    timings->count = 0;
+    timings->succeeded = 0;
+}
+
+void recordTiming(BenchTimings* timings, unsigned long long start, int succeeded) {
+    timings->samples[timings->count++] = (double)(metricsClock() - start);
+    timings->succeeded += succeeded != 0;
+}
+
+int compareSamples(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Print throughput and nearest-rank percentiles in microseconds
+void reportTimings(BenchTimings* timings) {
+    double total = 0;
+    int n = timings->count;
+    int i;
+
+    if (n == 0) {
+        printf("%-12s %10d\n", timings->name, 0);
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        total += timings->samples[i];
+    }
+    qsort(timings->samples, n, sizeof(double), compareSamples);
+
+    printf("%-12s %10d %12.0f %10d %10.2f %10.2f %10.2f %10.2f\n",
+           timings->name, n, total > 0 ? n * 1e9 / total : 0.0, timings->succeeded,
+           timings->samples[(n - 1) * 50 / 100] / 1000.0,
+           timings->samples[(n - 1) * 90 / 100] / 1000.0,
+           timings->samples[(n - 1) * 99 / 100] / 1000.0,
+           timings->samples[n - 1] / 1000.0);
+}
+
+void removeBenchFiles() {
+    remove(snapshotFilePath);
+    remove(journalFilePath);
+    remove(textFilePath);
+    removeArchiveFiles();
+}
@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hotelCsv.h"
+
+// Streaming CSV import and export. The reader pulls the file through a fixed
+// buffer and splits records by hand, so memory use does not depend on the
+// file size and no row goes through sscanf.
+
+int nextCsvChar(CsvReader* reader);
+int peekCsvChar(CsvReader* reader);
+int isValidCsvName(const char text[], int maxLength);
+
+// Load every row of a CSV file into the engine, then write one snapshot.
+// Rows are checked like interactive input: bad dates, unknown fields,
+// duplicate users and bookings that overlap an existing one are rejected.
+HotelStatus hotelImportCsv(const char path[], CsvImportResult* result) {
+    char record[CSV_MAX_RECORD_LEN];
+    char* fields[CSV_MAX_FIELDS];
+    int today, minute;
+    int count;
+
+    memset(result, 0, sizeof(CsvImportResult));
+    CsvReader* reader = (CsvReader*)malloc(sizeof(CsvReader));
+    if (reader == NULL) {
+        return HOTEL_ERR_IO;
+    }
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        free(reader);
+        return HOTEL_ERR_IO;
+    }
+    reader->length = 0;
+    reader->position = 0;
+    reader->linesRead = 0;
+    reader->lineNumber = 0;
+
+    getCurrentDateTime(&today, &minute);
+
+    while ((count = readCsvRecord(reader, record, fields)) != 0) {
+        if (count < 0 || !importCsvRecord(fields, count, today, minute, result)) {
+            fprintf(stderr, "Line %d: rejected %s\n", reader->lineNumber,
+                    count < 0 ? "record that is too long" : fields[0]);
+            result->rejected++;
+        }
+    }
+
+    fclose(reader->file);
+    free(reader);
+
+    // Rows bypass the journal; one snapshot makes the whole import durable
+    return saveData() ? HOTEL_OK : HOTEL_ERR_IO;
+}
+
+// Write rooms, then users, then reservations room by room in check-in
+// order, so a re-import never books for unknown users and appends to
+// each room index instead of inserting into it
+HotelStatus hotelExportCsv(const char path[]) {
+    char checkInDate[11], checkInTime[6], checkOutDate[11], checkOutTime[6];
+    int i, j;
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return HOTEL_ERR_IO;
+    }
+    setvbuf(file, NULL, _IOFBF, CSV_BUFFER_SIZE);
+
+    fputs("record,field1,field2,field3,field4,field5,field6\n", file);
+
+    for (i = 0; i < totalRooms; i++) {
+        fprintf(file, "room,%d,", rooms[i].roomNumber);
+        writeCsvField(file, roomTypes[rooms[i].typeId].name);
+        fprintf(file, ",%.2f\n", roomTypes[rooms[i].typeId].pricePerNight);
+    }
+
+    User* user = userList;
+    while (user != NULL) {
+        fputs("user,", file);
+        writeCsvField(file, user->username);
+        fputc(',', file);
+        writeCsvField(file, user->password);
+        fprintf(file, ",%d\n", user->isAdmin);
+        user = user->next;
+    }
+
+    for (i = 0; i < totalRooms; i++) {
+        RoomBookings* bookings = &roomBookings[i];
+        for (j = 0; j < bookings->count; j++) {
+            Reservation* reservation = bookings->items[j];
+            dayToDate(reservation->checkInDay, checkInDate);
+            minuteToTime(reservation->checkInMinute, checkInTime);
+            dayToDate(reservation->checkOutDay, checkOutDate);
+            minuteToTime(reservation->checkOutMinute, checkOutTime);
+
+            fputs("reservation,", file);
+            writeCsvField(file, reservation->username);
+            fprintf(file, ",%d,%s,%s,%s,%s\n", reservation->roomNumber,
+                    checkInDate, checkInTime, checkOutDate, checkOutTime);
+        }
+    }
+
+    int failed = ferror(file);
+    if (fclose(file) != 0) {
+        failed = 1;
+    }
+    return failed ? HOTEL_ERR_IO : HOTEL_OK;
+}
+
+int nextCsvChar(CsvReader* reader) {
+    if (reader->position == reader->length) {
+        reader->length = fread(reader->buffer, 1, CSV_BUFFER_SIZE, reader->file);
+        reader->position = 0;
+        if (reader->length == 0) {
+            return EOF;
+        }
+    }
+    return (unsigned char)reader->buffer[reader->position++];
+}
+
+int peekCsvChar(CsvReader* reader) {
+    int c = nextCsvChar(reader);
+    if (c != EOF) {
+        reader->position--;
+    }
+    return c;
+}
+
+// Split the next record into fields stored in record. Returns the number of
+// fields, 0 at end of file, or -1 if the record does not fit.
+int readCsvRecord(CsvReader* reader, char record[], char* fields[]) {
+    int count = 1;
+    int used = 0;
+    int quoted = 0;
+    int overflow = 0;
+    int c = nextCsvChar(reader);
+
+    if (c == EOF) {
+        return 0;
+    }
+    reader->lineNumber = ++reader->linesRead;
+    fields[0] = record;
+
+    for (; c != EOF; c = nextCsvChar(reader)) {
+        if (quoted) {
+            if (c == '"') {
+                if (peekCsvChar(reader) != '"') {
+                    quoted = 0;
+                    continue;
+                }
+                nextCsvChar(reader);
+            } else if (c == '\n') {
+                reader->linesRead++;
+            }
+        } else if (c == '"') {
+            quoted = 1;
+            continue;
+        } else if (c == ',') {
+            if (count == CSV_MAX_FIELDS || used == CSV_MAX_RECORD_LEN - 1) {
+                overflow = 1;
+                continue;
+            }
+            record[used++] = '\0';
+            fields[count++] = record + used;
+            continue;
+        } else if (c == '\n') {
+            break;
+        } else if (c == '\r') {
+            continue;
+        }
+
+        if (used < CSV_MAX_RECORD_LEN - 1) {
+            record[used++] = (char)c;
+        } else {
+            overflow = 1;
+        }
+    }
+
+    record[used] = '\0';
+    return overflow ? -1 : count;
+}
+
+// Apply one parsed row. Returns 0 if the row is rejected.
+int importCsvRecord(char* fields[], int count, int today, int minute, CsvImportResult* result) {
+    int roomNumber, isAdmin;
+    int checkInDay, checkInMinute, checkOutDay, checkOutMinute;
+    char* end;
+
+    // Blank lines and the header row
+    if ((count == 1 && fields[0][0] == '\0') || strcmp(fields[0], "record") == 0) {
+        return 1;
+    }
+
+    if (strcmp(fields[0], "room") == 0 && count == 4) {
+        double pricePerNight = strtod(fields[3], &end);
+        if (!parseCsvInt(fields[1], &roomNumber) || roomNumber < 1 ||
+            !isValidCsvName(fields[2], MAX_ROOM_TYPE_LEN) || end == fields[3] || *end != '\0') {
+            return 0;
+        }
+
+        restoreRoom(roomNumber, fields[2], pricePerNight);
+        result->rooms++;
+        return 1;
+    }
+
+    if (strcmp(fields[0], "user") == 0 && count == 4) {
+        if (!isValidCsvName(fields[1], MAX_NAME_LEN) || !isValidCsvName(fields[2], MAX_PASSWORD_LEN) ||
+            !parseCsvInt(fields[3], &isAdmin) || (isAdmin != 0 && isAdmin != 1) || findUser(fields[1]) != NULL) {
+            return 0;
+        }
+
+        addUser(fields[1], fields[2], isAdmin);
+        result->users++;
+        return 1;
+    }
+
+    if (strcmp(fields[0], "reservation") == 0 && count == 7) {
+        if (!isValidCsvName(fields[1], MAX_NAME_LEN) || !parseCsvInt(fields[2], &roomNumber) ||
+            !parseCsvDate(fields[3], &checkInDay) || !parseCsvTime(fields[4], &checkInMinute) ||
+            !parseCsvDate(fields[5], &checkOutDay) || !parseCsvTime(fields[6], &checkOutMinute)) {
+            return 0;
+        }
+
+        // Stays that are already over would only be expired again at startup
+        if (compareDateTime(checkOutDay, checkOutMinute, today, minute) < 0) {
+            result->expired++;
+            return 1;
+        }
+        if (hotelCheckBooking(roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute) != HOTEL_OK) {
+            return 0;
+        }
+
+        addReservation(fields[1], roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        result->reservations++;
+        return 1;
+    }
+
+    return 0;
+}
+
+int parseCsvInt(const char text[], int* value) {
+    int result = 0;
+    int digits = 0;
+
+    while (*text >= '0' && *text <= '9' && digits < 9) {
+        result = result * 10 + (*text++ - '0');
+        digits++;
+    }
+    *value = result;
+    return digits > 0 && *text == '\0';
+}
+
+// Same rules as isValidDate, without going through sscanf
+int parseCsvDate(const char text[], int* day) {
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        int isDash = i == 4 || i == 7;
+        if (isDash ? text[i] != '-' : (text[i] < '0' || text[i] > '9')) {
+            return 0;
+        }
+    }
+    if (text[10] != '\0') {
+        return 0;
+    }
+
+    int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10 + (text[3] - '0');
+    int month = (text[5] - '0') * 10 + (text[6] - '0');
+    int dayOfMonth = (text[8] - '0') * 10 + (text[9] - '0');
+    if (month < 1 || month > 12 || dayOfMonth < 1) {
+        return 0;
+    }
+    if (dayOfMonth > daysInMonth[month - 1] + (month == 2 && isLeapYear(year))) {
+        return 0;
+    }
+
+    *day = daysFromCivil(year, month, dayOfMonth);
+    return 1;
+}
+
+// Same rules as isValidTime
+int parseCsvTime(const char text[], int* minute) {
+    if (text[0] < '0' || text[0] > '2' || text[1] < '0' || text[1] > '9' || text[2] != ':' ||
+        text[3] < '0' || text[3] > '5' || text[4] < '0' || text[4] > '9' || text[5] != '\0') {
+        return 0;
+    }
+
+    int hour = (text[0] - '0') * 10 + (text[1] - '0');
+    if (hour > 23) {
+        return 0;
+    }
+    *minute = hour * 60 + (text[3] - '0') * 10 + (text[4] - '0');
+    return 1;
+}
+
+// Names end up in the ':'-separated data files, so ':' is not allowed
+int isValidCsvName(const char text[], int maxLength) {
+    size_t length = strlen(text);
+    return length > 0 && length < (size_t)maxLength && strchr(text, ':') == NULL;
+}
+
+void writeCsvField(FILE* file, const char text[]) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        fputs(text, file);
+        return;
+    }
+
+    fputc('"', file);
+    while (*text) {
+        if (*text == '"') {
+            fputc('"', file);
+        }
+        fputc(*text++, file);
+    }
+    fputc('"', file);
+}
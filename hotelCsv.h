@@ -0,0 +1,49 @@
+#ifndef HOTEL_CSV_H
+#define HOTEL_CSV_H
+
+// Bulk import and export of rooms, users and reservations as CSV. One file
+// holds all three; the first column names the record:
+//
+//   record,field1,field2,...
+//   room,<number>,<type>,<price>
+//   user,<username>,<password>,<isAdmin>
+//   reservation,<username>,<room>,<check-in date>,<check-in time>,<check-out date>,<check-out time>
+//
+// Dates are YYYY-MM-DD and times HH:MM. Fields may be quoted with "".
+
+#include "hotelEngine.h"
+
+#define CSV_BUFFER_SIZE (1 << 16)
+#define CSV_MAX_RECORD_LEN 1024
+#define CSV_MAX_FIELDS 8
+
+// Counts from one import. Rejected rows are reported on stderr by line.
+typedef struct CsvImportResult {
+    int rooms;
+    int users;
+    int reservations;
+    int expired;   // Reservations already checked out, skipped
+    int rejected;  // Malformed rows, duplicate users and overlapping bookings
+} CsvImportResult;
+
+// Streaming reader over a FILE with its own read buffer
+typedef struct CsvReader {
+    FILE* file;
+    char buffer[CSV_BUFFER_SIZE];
+    size_t length;
+    size_t position;
+    int linesRead;
+    int lineNumber;  // Line the last record started on
+} CsvReader;
+
+HotelStatus hotelImportCsv(const char path[], CsvImportResult* result);
+HotelStatus hotelExportCsv(const char path[]);
+
+int readCsvRecord(CsvReader* reader, char record[], char* fields[]);
+int importCsvRecord(char* fields[], int count, int today, int minute, CsvImportResult* result);
+int parseCsvInt(const char text[], int* value);
+int parseCsvDate(const char text[], int* day);
+int parseCsvTime(const char text[], int* minute);
+void writeCsvField(FILE* file, const char text[]);
+
+#endif
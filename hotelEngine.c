@@ -0,0 +1,3255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#define fsync _commit
+#define ftruncate _chsize
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
+
+// Binary snapshot layout: header, then the room, user and reservation
+// sections as fixed-width records, then a table of NUL-terminated strings.
+// Integers are stored in host byte order; the checksum covers everything
+// after the header.
+typedef struct SnapshotHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int checksum;
+    unsigned int roomCount;
+    unsigned int userCount;
+    unsigned int reservationCount;
+    unsigned int stringTableSize;
+    unsigned int journalSegment;  // Journal records of earlier segments are already included
+} SnapshotHeader;
+
+typedef struct SnapshotRoom {
+    int roomNumber;
+    unsigned int roomTypeOffset;
+    double pricePerNight;
+} SnapshotRoom;
+
+typedef struct SnapshotUser {
+    unsigned int usernameOffset;
+    unsigned int passwordOffset;
+    int isAdmin;
+    unsigned int reserved;
+} SnapshotUser;
+
+typedef struct SnapshotReservation {
+    unsigned int usernameOffset;
+    int roomNumber;
+    int checkInDay;
+    int checkOutDay;
+    short checkInMinute;
+    short checkOutMinute;
+    int locked;
+} SnapshotReservation;
+
+#define SNAPSHOT_V1_RESERVATION_SIZE offsetof(SnapshotReservation, locked) // Version 1 records end before locked
+
+// Read-only view of a whole file mapped into memory
+typedef struct MappedFile {
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+// Growable buffer used to build the snapshot string table
+typedef struct StringTable {
+    char* data;
+    unsigned int size;
+    unsigned int capacity;
+} StringTable;
+
+// One line of a text snapshot after tokenizing. Strings point into the
+// mapped file and are not NUL-terminated.
+typedef enum TextRecordKind {
+    TEXT_USER,
+    TEXT_RESERVATION,
+    TEXT_ROOM
+} TextRecordKind;
+
+typedef struct TextRecord {
+    TextRecordKind kind;
+    const char* name;       // Username, or the room type of a ROOM line
+    const char* password;
+    int nameLength;
+    int passwordLength;
+    int number;             // Room number, or isAdmin for a USER line
+    int checkInDay;
+    int checkOutDay;
+    short checkInMinute;
+    short checkOutMinute;
+    double pricePerNight;
+} TextRecord;
+
+// Newline-aligned share of a text snapshot and the records parsed from it
+typedef struct TextChunk {
+    const char* start;
+    const char* end;
+    TextRecord* records;
+    int count;
+    int capacity;
+    int failed;             // Ran out of memory or met a damaged reservation
+} TextChunk;
+
+// Built-in room types: always in the catalog, at these rates until a snapshot
+// or a rate change says otherwise
+typedef struct RoomTypeDefault {
+    const char* name;
+    const char* description;
+    double pricePerNight;
+} RoomTypeDefault;
+
+const RoomTypeDefault defaultRoomTypes[] = {
+    { "Standard", "Basic comfortable room", 1500.0 },
+    { "Deluxe", "Spacious room with better amenities", 2000.0 },
+    { "Suite", "Luxury accommodation", 3000.0 }
+};
+#define DEFAULT_ROOM_TYPES (int)(sizeof(defaultRoomTypes) / sizeof(defaultRoomTypes[0]))
+
+User* userList = NULL;
+MemoryPool userPool = { sizeof(User), 256, NULL, NULL, 0, 0 };
+MemoryPool reservationPool = { sizeof(Reservation), 1024, NULL, NULL, 0, 0 };
+User** userTable = NULL; // Open-addressing hash of userList keyed by username
+int userTableCapacity = 0;
+int userTableCount = 0;
+Reservation* reservationList = NULL;
+ReservationColumns reservationColumns = { NULL, NULL, NULL, NULL, NULL, 0, 0, 0 };
+int nextUserId = 1;
+int orphanReservations = 0;
+Room* rooms = NULL;
+int totalRooms = 0;
+int maxRooms = 0;
+RoomType* roomTypes = NULL; // Catalog indexed by Room.typeId; hotelStats.types is parallel to it
+int roomTypeCount = 0;
+int roomTypeCapacity = 0;
+HotelStats hotelStats = { 0, 0, NULL, 0 };
+Reservation** expiryHeap = NULL; // Min-heap of reservations ordered by check-out
+int expiryHeapSize = 0;
+int expiryHeapCapacity = 0;
+FILE* journalFile = NULL;
+int journalOpen = 0; // Set from hotelInit's openJournal to closeJournal; records are queued only while set
+JournalBatch journalQueue = { NULL, 0, 0, 0, 0, 0 };
+unsigned long long journalSequence = 0;
+unsigned long long journalDurableSequence = 0;
+unsigned long long journalFailedSequence = 0; // Above journalDurableSequence until a snapshot covers a failed write
+PersistMode persistMode = PERSIST_STRICT;
+int persistWindowMillis = DEFAULT_PERSIST_WINDOW_MS;
+int journalBackgroundWriter = 0;
+unsigned int journalSegment = 0; // Bumped by each checkpoint, marked at the start of each journal file
+unsigned long long journalRecordsSinceSnapshot = 0;
+unsigned long long journalBytesSinceSnapshot = 0;
+unsigned long long snapshotEveryRecords = SNAPSHOT_EVERY_RECORDS;
+unsigned long long snapshotEveryBytes = SNAPSHOT_EVERY_BYTES;
+int loaderThreads = 0; // Threads that parse a text snapshot, 0 for one per processor
+RoomBookings* roomBookings = NULL; // Parallel to rooms, same slot
+int* roomTable = NULL; // Open-addressing hash of room number to rooms slot + 1, 0 when empty
+int roomTableCapacity = 0;
+int occupancyBaseDay = 0; // First day covered by the occupancy bitmaps, a multiple of 64
+int freeRunsDeferred = 0; // Set while loading; the free-run trees are built once at the end
+char snapshotFilePath[MAX_PATH_LEN] = SNAPSHOT_FILE;
+char journalFilePath[MAX_PATH_LEN] = JOURNAL_FILE;
+char oldJournalFilePath[MAX_PATH_LEN + 4] = JOURNAL_FILE ".old";
+char textFilePath[MAX_PATH_LEN] = DATA_FILE;
+
+// Snapshot helpers used only in this file
+int mapFile(const char path[], MappedFile* mapped);
+void unmapFile(MappedFile* mapped);
+unsigned int addSnapshotString(StringTable* table, const char text[]);
+const char* getSnapshotString(const MappedFile* mapped, unsigned int tableStart, unsigned int tableSize, unsigned int offset, size_t maxLen);
+
+// Text snapshot loader used only in this file
+int countLoaderThreads(size_t size);
+#ifdef _WIN32
+DWORD WINAPI parseTextChunk(LPVOID argument);
+#else
+void* parseTextChunk(void* argument);
+#endif
+int parseTextRecord(const char* line, const char* end, TextRecord* record);
+const char* nextTextField(const char** cursor, const char* end, int* length);
+int parseTextInt(const char* text, int length, int* value);
+int parseTextDate(const char* text, int length, int* day);
+int parseTextMinute(const char* hourText, int hourLength, const char* minuteText, int minuteLength, short* minute);
+void applyTextRecord(const TextRecord* record);
+
+int isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+// Days in a month of 1..12
+int monthLength(int year, int month) {
+    static const int lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return lengths[month - 1] + (month == 2 && isLeapYear(year));
+}
+
+int isValidDate(char date[]) {
+    // Check format YYYY-MM-DD
+    if (strlen(date) != 10 || date[4] != '-' || date[7] != '-') {
+        return 0;
+    }
+    
+    int year, month, day;
+    sscanf(date, "%d-%d-%d", &year, &month, &day);
+    
+    if (month < 1 || month > 12) return 0;
+    if (day < 1 || day > 31) return 0;
+    
+    // Check days in month
+    if (month == 2) {
+        if (isLeapYear(year)) {
+            if (day > 29) return 0;
+        } else {
+            if (day > 28) return 0;
+        }
+    } else if (month == 4 || month == 6 || month == 9 || month == 11) {
+        if (day > 30) return 0;
+    }
+    
+    return 1;
+}
+
+int isValidTime(char time[]) {
+    // Check format HH:MM
+    if (strlen(time) != 5 || time[2] != ':') {
+        return 0;
+    }
+    
+    int hour, minute;
+    sscanf(time, "%d:%d", &hour, &minute);
+    
+    if (hour < 0 || hour > 23) return 0;
+    if (minute < 0 || minute > 59) return 0;
+    
+    return 1;
+}
+
+// Check if a room is currently booked for any date
+int isRoomBooked(int roomNumber) {
+    RoomBookings* bookings = getRoomBookings(roomNumber, 0);
+    return bookings != NULL && bookings->count > 0;
+}
+
+// Check if a room is available for specific dates
+int isRoomAvailableForDates(int roomNumber, int checkInDay, int checkOutDay) {
+    unsigned long long start = metricsClock();
+    int available = isRoomAvailableExcluding(roomNumber, checkInDay, checkOutDay, NULL);
+    metricsRecord(METRIC_AVAILABILITY, start);
+    return available;
+}
+
+// Availability check that ignores one reservation, used when moving a booking
+int isRoomAvailableExcluding(int roomNumber, int checkInDay, int checkOutDay, Reservation* exclude) {
+    RoomBookings* bookings = getRoomBookings(roomNumber, 0);
+    if (bookings == NULL || bookings->count == 0) {
+        return 1;
+    }
+    
+    // Bookings in a room never overlap, so once they are sorted by check-in
+    // their check-out dates are sorted too. The only booking that can clash
+    // is the last one starting on or before the requested check-out date.
+    int pos = findBookingPosition(bookings, checkOutDay);
+    if (pos > 0 && bookings->items[pos - 1] == exclude) {
+        pos--;
+    }
+    if (pos > 0 && checkInDay <= bookings->items[pos - 1]->checkOutDay) {
+        return 0;
+    }
+    
+    return 1; 
+}
+
+// Get the booking index of a room. With create set, an unknown room is added
+// as a Standard room: text snapshots list reservations before their rooms.
+RoomBookings* getRoomBookings(int roomNumber, int create) {
+    int slot = findRoomSlot(roomNumber);
+    
+    if (slot < 0) {
+        if (!create || roomNumber < 1) {
+            return NULL;
+        }
+        slot = insertRoom(roomNumber, internRoomType(defaultRoomTypes[0].name));
+    }
+    
+    return &roomBookings[slot];
+}
+
+// Multiplicative hash of a room number; floor schemes such as 101..130,
+// 201..230 spread evenly over the table
+unsigned int hashRoomNumber(int roomNumber) {
+    return (unsigned int)roomNumber * 2654435761u;
+}
+
+// Slot of a room in rooms and roomBookings, or -1 if there is no such room
+int findRoomSlot(int roomNumber) {
+    if (roomTableCapacity == 0) {
+        return -1;
+    }
+    
+    unsigned int mask = (unsigned int)roomTableCapacity - 1;
+    unsigned int index = hashRoomNumber(roomNumber) & mask;
+    while (roomTable[index] != 0) {
+        int slot = roomTable[index] - 1;
+        if (rooms[slot].roomNumber == roomNumber) {
+            return slot;
+        }
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
+
+Room* findRoom(int roomNumber) {
+    int slot = findRoomSlot(roomNumber);
+    return slot >= 0 ? &rooms[slot] : NULL;
+}
+
+// Rebuild the directory with room for at least minRooms rooms at load <= 1/2.
+// Rooms are never removed, so the table is rebuilt straight from the slots.
+void growRoomTable(int minRooms) {
+    int capacity = roomTableCapacity > 0 ? roomTableCapacity : 16;
+    int slot;
+    
+    while (capacity < minRooms * 2) {
+        capacity *= 2;
+    }
+    if (capacity == roomTableCapacity) {
+        return;
+    }
+    
+    free(roomTable);
+    roomTable = (int*)calloc(capacity, sizeof(int));
+    roomTableCapacity = capacity;
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (slot = 0; slot < totalRooms; slot++) {
+        unsigned int index = hashRoomNumber(rooms[slot].roomNumber) & mask;
+        while (roomTable[index] != 0) {
+            index = (index + 1) & mask;
+        }
+        roomTable[index] = slot + 1;
+    }
+}
+
+// Append a room the directory does not know yet and return its slot
+int insertRoom(int roomNumber, int typeId) {
+    resizeRooms();
+    growRoomTable(totalRooms + 1);
+    
+    int slot = totalRooms++;
+    rooms[slot].roomNumber = roomNumber;
+    rooms[slot].typeId = typeId;
+    addRoomTypeSlot(typeId, slot);
+    memset(&roomBookings[slot], 0, sizeof(RoomBookings));
+    buildFreeRuns(&roomBookings[slot]);
+    
+    unsigned int mask = (unsigned int)roomTableCapacity - 1;
+    unsigned int index = hashRoomNumber(roomNumber) & mask;
+    while (roomTable[index] != 0) {
+        index = (index + 1) & mask;
+    }
+    roomTable[index] = slot + 1;
+    
+    countRoomStats(roomNumber, 1);
+    return slot;
+}
+
+// Binary search for the first booking that checks in after the given date
+int findBookingPosition(RoomBookings* bookings, int day) {
+    int low = 0;
+    int high = bookings->count;
+    
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (bookings->items[mid]->checkInDay <= day) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+void indexReservation(Reservation* reservation) {
+    RoomBookings* bookings = getRoomBookings(reservation->roomNumber, 1);
+    if (bookings == NULL) {
+        return;
+    }
+    
+    if (bookings->count >= bookings->capacity) {
+        bookings->capacity = bookings->capacity > 0 ? bookings->capacity * 2 : 4;
+        bookings->items = (Reservation**)realloc(bookings->items, bookings->capacity * sizeof(Reservation*));
+    }
+    
+    countRoomStats(reservation->roomNumber, -1);
+    int pos = findBookingPosition(bookings, reservation->checkInDay);
+    memmove(&bookings->items[pos + 1], &bookings->items[pos], (bookings->count - pos) * sizeof(Reservation*));
+    bookings->items[pos] = reservation;
+    bookings->count++;
+    countRoomStats(reservation->roomNumber, 1);
+    setOccupancy(bookings, reservation->checkInDay, reservation->checkOutDay, 1);
+    countStayNights(rooms[bookings - roomBookings].typeId, reservation->checkInDay,
+                    stayEndNight(reservation->checkInDay, reservation->checkOutDay), 1);
+}
+
+void unindexReservation(Reservation* reservation) {
+    RoomBookings* bookings = getRoomBookings(reservation->roomNumber, 0);
+    if (bookings == NULL) {
+        return;
+    }
+    
+    // Walk back from the insertion point over bookings with the same check-in date
+    int pos = findBookingPosition(bookings, reservation->checkInDay);
+    while (pos > 0) {
+        pos--;
+        if (bookings->items[pos] == reservation) {
+            countRoomStats(reservation->roomNumber, -1);
+            memmove(&bookings->items[pos], &bookings->items[pos + 1], (bookings->count - pos - 1) * sizeof(Reservation*));
+            bookings->count--;
+            countRoomStats(reservation->roomNumber, 1);
+            
+            setOccupancy(bookings, reservation->checkInDay, reservation->checkOutDay, 0);
+            markOccupancy(bookings, reservation->checkInDay, reservation->checkOutDay);
+            countStayNights(rooms[bookings - roomBookings].typeId, reservation->checkInDay,
+                            stayEndNight(reservation->checkInDay, reservation->checkOutDay), -1);
+            return;
+        }
+        if (bookings->items[pos]->checkInDay != reservation->checkInDay) {
+            return;
+        }
+    }
+}
+
+void initializeRooms() {
+    int today, minute;
+    getCurrentDateTime(&today, &minute);
+    occupancyBaseDay = today - ((today % 64) + 64) % 64;
+    
+    int i;
+    for (i = 0; i < DEFAULT_ROOM_TYPES; i++) {
+        int typeId = internRoomType(defaultRoomTypes[i].name);
+        strcpy(roomTypes[typeId].description, defaultRoomTypes[i].description);
+        roomTypes[typeId].pricePerNight = defaultRoomTypes[i].pricePerNight;
+    }
+    
+    maxRooms = 10;
+    rooms = (Room*)malloc(maxRooms * sizeof(Room));
+    roomBookings = (RoomBookings*)malloc(maxRooms * sizeof(RoomBookings));
+    for (i = 1; i <= maxRooms; i++) {
+        // Assign different room types
+        if (i <= 4) {
+            insertRoom(i, internRoomType("Standard"));
+        } else if (i <= 7) {
+            insertRoom(i, internRoomType("Deluxe"));
+        } else {
+            insertRoom(i, internRoomType("Suite"));
+        }
+    }
+}
+
+// Set or clear the bitmap bits for days fromDay..toDay, clipped to the horizon
+void setOccupancy(RoomBookings* bookings, int fromDay, int toDay, int booked) {
+    int first = fromDay - occupancyBaseDay;
+    int last = toDay - occupancyBaseDay;
+    
+    if (first < 0) {
+        first = 0;
+    }
+    if (last >= OCCUPANCY_DAYS) {
+        last = OCCUPANCY_DAYS - 1;
+    }
+    if (first > last) {
+        return;
+    }
+    
+    int firstWord = first / 64;
+    int lastWord = last / 64;
+    while (first <= last) {
+        int word = first / 64;
+        int bit = first % 64;
+        int span = last - first + 1 < 64 - bit ? last - first + 1 : 64 - bit;
+        unsigned long long bits = (span == 64 ? ~0ULL : ((1ULL << span) - 1)) << bit;
+        
+        if (booked) {
+            bookings->occupancy[word] |= bits;
+        } else {
+            bookings->occupancy[word] &= ~bits;
+        }
+        first += span;
+    }
+    if (!freeRunsDeferred) {
+        updateFreeRuns(bookings, firstWord, lastWord);
+    }
+}
+
+// Re-set the bits of every booking in the room that touches fromDay..toDay
+void markOccupancy(RoomBookings* bookings, int fromDay, int toDay) {
+    int pos = findBookingPosition(bookings, toDay);
+    while (pos > 0 && bookings->items[pos - 1]->checkOutDay >= fromDay) {
+        pos--;
+        setOccupancy(bookings, bookings->items[pos]->checkInDay, bookings->items[pos]->checkOutDay, 1);
+    }
+}
+
+// Build the bitmap words covering fromDay..toDay. Returns 0 if the range
+// is not entirely inside the horizon.
+int buildOccupancyMask(int fromDay, int toDay, unsigned long long mask[], int* firstWord, int* lastWord) {
+    int first = fromDay - occupancyBaseDay;
+    int last = toDay - occupancyBaseDay;
+    int word;
+    
+    if (first < 0 || last >= OCCUPANCY_DAYS || first > last) {
+        return 0;
+    }
+    
+    *firstWord = first / 64;
+    *lastWord = last / 64;
+    for (word = *firstWord; word <= *lastWord; word++) {
+        unsigned long long bits = ~0ULL;
+        if (word == *firstWord) {
+            bits &= ~0ULL << (first % 64);
+        }
+        if (word == *lastWord && last % 64 != 63) {
+            bits &= (1ULL << (last % 64 + 1)) - 1;
+        }
+        mask[word] = bits;
+    }
+    return 1;
+}
+
+// Slide the bitmaps forward so their first word holds today
+void advanceOccupancyHorizon(int today) {
+    int shift = (today - occupancyBaseDay) / 64;
+    int i, j;
+    
+    if (shift <= 0) {
+        return;
+    }
+    
+    // After a gap longer than the horizon none of the old words are kept
+    int dropped = shift < OCCUPANCY_WORDS ? shift : OCCUPANCY_WORDS;
+    shiftNightLedgers(shift * 64);
+    occupancyBaseDay += shift * 64;
+    int tailStart = occupancyBaseDay + (OCCUPANCY_WORDS - dropped) * 64;
+    
+    for (i = 0; i < totalRooms; i++) {
+        RoomBookings* bookings = &roomBookings[i];
+        memmove(bookings->occupancy, bookings->occupancy + dropped, (OCCUPANCY_WORDS - dropped) * sizeof(unsigned long long));
+        memset(bookings->occupancy + OCCUPANCY_WORDS - dropped, 0, dropped * sizeof(unsigned long long));
+        buildFreeRuns(bookings);
+        
+        // Only the latest bookings can reach the newly uncovered days
+        for (j = bookings->count - 1; j >= 0 && bookings->items[j]->checkOutDay >= tailStart; j--) {
+            Reservation* reservation = bookings->items[j];
+            int firstNight = reservation->checkInDay > tailStart ? reservation->checkInDay : tailStart;
+            setOccupancy(bookings, reservation->checkInDay, reservation->checkOutDay, 1);
+            countStayNights(rooms[i].typeId, firstNight, stayEndNight(reservation->checkInDay, reservation->checkOutDay), 1);
+        }
+    }
+}
+
+// Collect rooms of the given type ("all" for any) that are free for the whole
+// date range. Returns the number of rooms written to roomNumbers.
+int searchRooms(char roomType[], int checkInDay, int checkOutDay, int roomNumbers[], int maxResults) {
+    unsigned long long start = metricsClock();
+    unsigned long long mask[OCCUPANCY_WORDS];
+    int firstWord, lastWord;
+    int inHorizon = buildOccupancyMask(checkInDay, checkOutDay, mask, &firstWord, &lastWord);
+    int* slots = NULL;
+    int candidates = totalRooms;
+    int count = 0;
+    int i, word;
+    
+    // A type filter only walks that type's rooms
+    if (strcmp(roomType, "all") != 0) {
+        int typeId = findRoomType(roomType);
+        slots = typeId >= 0 ? roomTypes[typeId].roomSlots : NULL;
+        candidates = typeId >= 0 ? roomTypes[typeId].roomCount : 0;
+    }
+    
+    for (i = 0; i < candidates && count < maxResults; i++) {
+        int slot = slots != NULL ? slots[i] : i;
+        int roomNumber = rooms[slot].roomNumber;
+        RoomBookings* bookings = &roomBookings[slot];
+        int available = 1;
+        
+        if (bookings->count == 0) {
+            available = 1;
+        } else if (inHorizon) {
+            unsigned long long clash = 0;
+            for (word = firstWord; word <= lastWord; word++) {
+                clash |= bookings->occupancy[word] & mask[word];
+            }
+            available = clash == 0;
+        } else {
+            available = isRoomAvailableForDates(roomNumber, checkInDay, checkOutDay);
+        }
+        
+        if (available) {
+            roomNumbers[count++] = roomNumber;
+        }
+    }
+    
+    metricsRecord(METRIC_SEARCH, start);
+    return count;
+}
+
+// Earliest check-in day from fromDay on at which a stay of the given nights
+// fits in the room roomNumber, or in any room of roomType ("all" for any)
+// when roomNumber is 0. Returns the room, the first one on a tie, or 0 if
+// there is no such room or nights is not 1..OCCUPANCY_DAYS; the day goes to
+// checkInDay.
+int findEarliestSlot(const char roomType[], int roomNumber, int fromDay, int nights, int* checkInDay) {
+    unsigned long long start = metricsClock();
+    int* slots = NULL;
+    int candidates = totalRooms;
+    int best = INT_MAX;
+    int bestRoom = 0;
+    int i;
+    
+    if (nights < 1 || nights > OCCUPANCY_DAYS) {
+        return 0;
+    }
+    if (roomNumber != 0) {
+        int slot = findRoomSlot(roomNumber);
+        if (slot >= 0) {
+            best = earliestFreeDay(&roomBookings[slot], fromDay, nights + 1, INT_MAX);
+            bestRoom = roomNumber;
+        }
+    } else {
+        if (strcmp(roomType, "all") != 0) {
+            int typeId = findRoomType(roomType);
+            slots = typeId >= 0 ? roomTypes[typeId].roomSlots : NULL;
+            candidates = typeId >= 0 ? roomTypes[typeId].roomCount : 0;
+        }
+        
+        // Each room only has to beat the best day found so far
+        for (i = 0; i < candidates && best > fromDay; i++) {
+            int slot = slots != NULL ? slots[i] : i;
+            int day = earliestFreeDay(&roomBookings[slot], fromDay, nights + 1, best);
+            if (day < best) {
+                best = day;
+                bestRoom = rooms[slot].roomNumber;
+            }
+        }
+    }
+    
+    if (bestRoom != 0) {
+        *checkInDay = best;
+    }
+    metricsRecord(METRIC_EARLIEST_SLOT, start);
+    return bestRoom;
+}
+
+// Earliest day from fromDay on that starts a run of at least days free days
+// in a room, or limitDay if no such run starts before limitDay. Inside the horizon this
+// is one walk down the room's free-run tree; a run that does not fit there
+// is continued past its end through the room's index.
+int earliestFreeDay(RoomBookings* bookings, int fromDay, int days, int limitDay) {
+    int start = fromDay - occupancyBaseDay;
+    int carry = 0;
+    
+    if (start < 0 || start >= OCCUPANCY_DAYS) {
+        return findFreeRunInIndex(bookings, fromDay, days);
+    }
+    
+    int found = searchFreeRuns(bookings, 1, 0, OCCUPANCY_DAYS, start, limitDay - occupancyBaseDay, days, &carry);
+    if (found >= 0) {
+        return occupancyBaseDay + found;
+    }
+    
+    // The only run that can still fit is the one that reaches the end of the horizon
+    int tail = OCCUPANCY_DAYS - bookings->freeRuns[1].suffix;
+    int day = occupancyBaseDay + (tail > start ? tail : start);
+    if (day >= limitDay) {
+        return limitDay;
+    }
+    return findFreeRunInIndex(bookings, day, days);
+}
+
+// Start of the leftmost run of at least days free days that begins between
+// positions start and limit and ends inside the node covering span days from
+// position first, or -1 if there is none. carry holds the free days from
+// start on that run up to the node, and on -1 those that run up to its end.
+int searchFreeRuns(const RoomBookings* bookings, int node, int first, int span, int start, int limit, int days, int* carry) {
+    FreeRun run;
+    
+    if (first + span <= start) {
+        return -1;
+    }
+    if (first - *carry >= limit) {
+        return -1;
+    }
+    
+    // A node wholly after start is settled by its summary unless a run inside it fits
+    if (first >= start) {
+        run = bookings->freeRuns[node];
+        if (*carry + run.prefix >= days) {
+            int day = first - *carry;
+            return day < limit ? day : -1;
+        }
+        if (run.longest < days) {
+            *carry = run.prefix == span ? *carry + span : run.suffix;
+            return -1;
+        }
+    }
+    
+    if (node >= OCCUPANCY_WORDS) {
+        return searchFreeWord(bookings->occupancy[node - OCCUPANCY_WORDS], first, start, limit, days, carry);
+    }
+    
+    int found = searchFreeRuns(bookings, node * 2, first, span / 2, start, limit, days, carry);
+    if (found >= 0) {
+        return found;
+    }
+    return searchFreeRuns(bookings, node * 2 + 1, first + span / 2, span / 2, start, limit, days, carry);
+}
+
+// searchFreeRuns for one bitmap word, one run of free bits at a time
+int searchFreeWord(unsigned long long word, int first, int start, int limit, int days, int* carry) {
+    int bit = 0;
+    
+    // Days before start count as booked
+    if (start > first) {
+        word |= (1ULL << (start - first)) - 1;
+    }
+    
+    while (bit < 64) {
+        unsigned long long rest = word >> bit;
+        int run = rest == 0 ? 64 - bit : lowestBit(rest);
+        
+        if (run > 0) {
+            if (*carry + run >= days) {
+                int day = first + bit - *carry;
+                return day < limit ? day : -1;
+            }
+            *carry += run;
+            bit += run;
+            if (bit == 64) {
+                return -1;
+            }
+        }
+        
+        // Skip the booked days that end the run
+        *carry = 0;
+        rest = ~word >> bit;
+        if (rest == 0) {
+            return -1;
+        }
+        bit += lowestBit(rest);
+        if (first + bit >= limit) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+// Earliest day from fromDay on that starts a run of at least days free days
+// in a room, walking its index; stays are sorted by check-in and do not overlap.
+int findFreeRunInIndex(RoomBookings* bookings, int fromDay, int days) {
+    int day = fromDay;
+    int pos = findBookingPosition(bookings, fromDay);
+    
+    // The stay checked in last before fromDay may still run over it
+    if (pos > 0 && bookings->items[pos - 1]->checkOutDay >= day) {
+        day = bookings->items[pos - 1]->checkOutDay + 1;
+    }
+    
+    for (; pos < bookings->count; pos++) {
+        Reservation* reservation = bookings->items[pos];
+        if (reservation->checkInDay - day >= days) {
+            break;
+        }
+        if (reservation->checkOutDay >= day) {
+            day = reservation->checkOutDay + 1;
+        }
+    }
+    return day;
+}
+
+// Recompute a room's whole free-run tree from its bitmap
+void buildFreeRuns(RoomBookings* bookings) {
+    updateFreeRuns(bookings, 0, OCCUPANCY_WORDS - 1);
+}
+
+// Recompute the leaves for bitmap words firstWord..lastWord and the nodes above them
+void updateFreeRuns(RoomBookings* bookings, int firstWord, int lastWord) {
+    int low = OCCUPANCY_WORDS + firstWord;
+    int high = OCCUPANCY_WORDS + lastWord;
+    int span = 64;
+    int changed = 0;
+    int node;
+    
+    for (node = low; node <= high; node++) {
+        changed |= storeFreeRun(&bookings->freeRuns[node], summarizeFreeWord(bookings->occupancy[node - OCCUPANCY_WORDS]));
+    }
+    
+    // Stop climbing once a level comes out as it was
+    while (low > 1 && changed) {
+        low /= 2;
+        high /= 2;
+        changed = 0;
+        for (node = low; node <= high; node++) {
+            FreeRun* left = &bookings->freeRuns[node * 2];
+            FreeRun* right = &bookings->freeRuns[node * 2 + 1];
+            FreeRun merged;
+            int middle = left->suffix + right->prefix;
+            
+            merged.prefix = (short)(left->prefix == span ? span + right->prefix : left->prefix);
+            merged.suffix = (short)(right->suffix == span ? span + left->suffix : right->suffix);
+            merged.longest = left->longest > right->longest ? left->longest : right->longest;
+            if (middle > merged.longest) {
+                merged.longest = (short)middle;
+            }
+            changed |= storeFreeRun(&bookings->freeRuns[node], merged);
+        }
+        span *= 2;
+    }
+}
+
+// Overwrite a tree node. Returns 0 if it already held the same summary.
+int storeFreeRun(FreeRun* node, FreeRun run) {
+    if (node->prefix == run.prefix && node->suffix == run.suffix && node->longest == run.longest) {
+        return 0;
+    }
+    *node = run;
+    return 1;
+}
+
+// Free days at either end of one bitmap word and the longest run in it
+FreeRun summarizeFreeWord(unsigned long long bits) {
+    unsigned long long runs[6];
+    unsigned long long found = ~0ULL;
+    FreeRun run = { 64, 64, 64 };
+    int length = 0;
+    int level;
+    
+    if (bits == 0) {
+        return run;
+    }
+    
+    // Bit p of runs[k] is set when days p..p+2^k-1 are all free. The longest
+    // run is built up from the longest power of two down, without branches.
+    runs[0] = ~bits;
+    for (level = 1; level < 6; level++) {
+        runs[level] = runs[level - 1] & (runs[level - 1] >> (1 << (level - 1)));
+    }
+    for (level = 5; level >= 0; level--) {
+        unsigned long long longer = found & (runs[level] >> length);
+        int fits = longer != 0;
+        found = fits ? longer : found;
+        length += fits << level;
+    }
+    run.prefix = (short)lowestBit(bits);
+    run.suffix = (short)(63 - highestBit(bits));
+    run.longest = (short)length;
+    return run;
+}
+
+// Catalog id of a room type, or -1 if no room has ever had that type
+int findRoomType(const char name[]) {
+    int i;
+    for (i = 0; i < roomTypeCount; i++) {
+        if (strcmp(roomTypes[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Catalog id of a room type for a room being created. A type seen for the
+// first time takes pricePerNight as its rate; a known one keeps its own.
+int defineRoomType(const char name[], double pricePerNight) {
+    int known = findRoomType(name) >= 0;
+    int typeId = internRoomType(name);
+    
+    if (!known) {
+        roomTypes[typeId].pricePerNight = pricePerNight;
+    }
+    return typeId;
+}
+
+// Catalog id of a room type, adding it (with its statistics) if it is new
+int internRoomType(const char name[]) {
+    int typeId = findRoomType(name);
+    if (typeId >= 0) {
+        return typeId;
+    }
+    
+    if (roomTypeCount >= roomTypeCapacity) {
+        roomTypeCapacity = roomTypeCapacity > 0 ? roomTypeCapacity * 2 : 4;
+        roomTypes = (RoomType*)realloc(roomTypes, roomTypeCapacity * sizeof(RoomType));
+        hotelStats.types = (RoomTypeStats*)realloc(hotelStats.types, roomTypeCapacity * sizeof(RoomTypeStats));
+    }
+    
+    typeId = roomTypeCount++;
+    memset(&roomTypes[typeId], 0, sizeof(RoomType));
+    snprintf(roomTypes[typeId].name, MAX_ROOM_TYPE_LEN, "%s", name);
+    memset(&hotelStats.types[typeId], 0, sizeof(RoomTypeStats));
+    hotelStats.typeCount = roomTypeCount;
+    return typeId;
+}
+
+// Add a room slot to a type's room list, keeping the list ascending
+void addRoomTypeSlot(int typeId, int slot) {
+    RoomType* type = &roomTypes[typeId];
+    int pos = type->roomCount;
+    
+    if (type->roomCount >= type->slotCapacity) {
+        type->slotCapacity = type->slotCapacity > 0 ? type->slotCapacity * 2 : 8;
+        type->roomSlots = (int*)realloc(type->roomSlots, type->slotCapacity * sizeof(int));
+    }
+    
+    // New rooms take the highest slot, so this only moves entries when a room changes type
+    while (pos > 0 && type->roomSlots[pos - 1] > slot) {
+        type->roomSlots[pos] = type->roomSlots[pos - 1];
+        pos--;
+    }
+    type->roomSlots[pos] = slot;
+    type->roomCount++;
+}
+
+void removeRoomTypeSlot(int typeId, int slot) {
+    RoomType* type = &roomTypes[typeId];
+    int i;
+    
+    for (i = 0; i < type->roomCount; i++) {
+        if (type->roomSlots[i] == slot) {
+            memmove(&type->roomSlots[i], &type->roomSlots[i + 1], (type->roomCount - i - 1) * sizeof(int));
+            type->roomCount--;
+            return;
+        }
+    }
+}
+
+// Add (sign = 1) or withdraw (sign = -1) one room's share of the statistics.
+// Callers withdraw it before changing the room or its bookings and add it back after.
+void countRoomStats(int roomNumber, int sign) {
+    int slot = findRoomSlot(roomNumber);
+    if (slot < 0) {
+        return;
+    }
+    
+    int reservations = roomBookings[slot].count;
+    int booked = reservations > 0;
+    RoomTypeStats* stats = &hotelStats.types[rooms[slot].typeId];
+    
+    hotelStats.bookedRooms += sign * booked;
+    stats->rooms += sign;
+    stats->bookedRooms += sign * booked;
+    stats->reservations += sign * reservations;
+}
+
+// FNV-1a hash of a username
+unsigned int hashUsername(const char username[]) {
+    unsigned int hash = 2166136261u;
+    while (*username) {
+        hash ^= (unsigned char)*username++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+User* findUser(char username[]) {
+    int slot = findUserSlot(username);
+    return slot >= 0 ? userTable[slot] : NULL;
+}
+
+// Position of a user in userTable, or -1 if there is no such user
+int findUserSlot(char username[]) {
+    if (userTableCapacity == 0) {
+        return -1;
+    }
+    
+    unsigned int mask = userTableCapacity - 1;
+    unsigned int slot = hashUsername(username) & mask;
+    while (userTable[slot] != NULL) {
+        if (strcmp(userTable[slot]->username, username) == 0) {
+            return (int)slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void insertUserIndex(User* user) {
+    // Keep the table at most half full so probe runs stay short
+    if ((userTableCount + 1) * 2 > userTableCapacity) {
+        User** oldTable = userTable;
+        int oldCapacity = userTableCapacity;
+        int i;
+        
+        userTableCapacity = oldCapacity > 0 ? oldCapacity * 2 : 64;
+        userTable = (User**)calloc(userTableCapacity, sizeof(User*));
+        userTableCount = 0;
+        
+        for (i = 0; i < oldCapacity; i++) {
+            if (oldTable[i] != NULL) {
+                insertUserIndex(oldTable[i]);
+            }
+        }
+        free(oldTable);
+    }
+    
+    unsigned int mask = userTableCapacity - 1;
+    unsigned int slot = hashUsername(user->username) & mask;
+    while (userTable[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    userTable[slot] = user;
+    userTableCount++;
+}
+
+void removeUserIndex(User* user) {
+    if (userTableCapacity == 0) {
+        return;
+    }
+    
+    unsigned int mask = userTableCapacity - 1;
+    unsigned int slot = hashUsername(user->username) & mask;
+    while (userTable[slot] != NULL && userTable[slot] != user) {
+        slot = (slot + 1) & mask;
+    }
+    if (userTable[slot] == NULL) {
+        return;
+    }
+    
+    // Backward-shift deletion: pull later entries of the probe run into the gap
+    unsigned int gap = slot;
+    unsigned int next = (slot + 1) & mask;
+    while (userTable[next] != NULL) {
+        unsigned int home = hashUsername(userTable[next]->username) & mask;
+        if (((next - home) & mask) >= ((next - gap) & mask)) {
+            userTable[gap] = userTable[next];
+            gap = next;
+        }
+        next = (next + 1) & mask;
+    }
+    userTable[gap] = NULL;
+    userTableCount--;
+}
+
+void addUser(char username[], char password[], int isAdmin) {
+    if (findUser(username) != NULL) {
+        return;
+    }
+    User* newUser = (User*)poolAlloc(&userPool);
+    strcpy(newUser->username, username);
+    strcpy(newUser->password, password);
+    newUser->isAdmin = isAdmin;
+    newUser->id = nextUserId++;
+    newUser->reservations = NULL;
+    newUser->prev = NULL;
+    newUser->next = userList;
+    if (userList != NULL) {
+        userList->prev = newUser;
+    }
+    userList = newUser;
+    insertUserIndex(newUser);
+    
+    if (orphanReservations > 0) {
+        adoptOrphanReservations(newUser);
+    }
+}
+
+User* authenticateUser(char username[], char password[]) {
+    User* user = findUser(username);
+    if (user != NULL && strcmp(user->password, password) == 0) {
+        return user; 
+    }
+    return NULL; 
+}
+
+// Reservations start out locked to their room; bookings the engine placed
+// itself are unlocked by the caller
+Reservation* addReservation(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    Reservation* newReservation = (Reservation*)poolAlloc(&reservationPool);
+    strcpy(newReservation->username, username);
+    newReservation->roomNumber = roomNumber;
+    newReservation->locked = 1;
+    newReservation->checkInDay = checkInDay;
+    newReservation->checkInMinute = (short)checkInMinute;
+    newReservation->checkOutDay = checkOutDay;
+    newReservation->checkOutMinute = (short)checkOutMinute;
+    newReservation->prev = NULL;
+    newReservation->next = reservationList;
+    if (reservationList != NULL) {
+        reservationList->prev = newReservation;
+    }
+    reservationList = newReservation;
+    addReservationRow(newReservation);
+    
+    User* owner = findUser(username);
+    if (owner != NULL) {
+        linkUserReservation(owner, newReservation);
+    } else {
+        newReservation->userNext = NULL;
+        newReservation->userPrev = NULL;
+        orphanReservations++;
+    }
+    indexReservation(newReservation);
+    scheduleExpiry(newReservation);
+    hotelStats.totalReservations++;
+    return newReservation;
+}
+
+// Move a reservation to new dates, keeping the room index and expiry heap in step
+void updateReservationDates(Reservation* reservation, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    unindexReservation(reservation);
+    reservation->checkInDay = checkInDay;
+    reservation->checkInMinute = (short)checkInMinute;
+    reservation->checkOutDay = checkOutDay;
+    reservation->checkOutMinute = (short)checkOutMinute;
+    indexReservation(reservation);
+    updateReservationRow(reservation);
+    
+    // The check-out may have moved either way
+    siftExpiryUp(reservation->heapIndex);
+    siftExpiryDown(reservation->heapIndex);
+}
+
+// Move a reservation to another room with the same dates. The caller makes
+// sure the room is free; journal replay may briefly overlap two stays while
+// it applies a set of moves one at a time.
+void moveReservation(Reservation* reservation, int roomNumber) {
+    unindexReservation(reservation);
+    reservation->roomNumber = roomNumber;
+    indexReservation(reservation);
+    updateReservationRow(reservation);
+}
+
+// Unlink a reservation from the list and the room index and release it
+void deleteReservation(Reservation* reservation) {
+    unindexReservation(reservation);
+    unscheduleExpiry(reservation);
+    removeReservationRow(reservation);
+    hotelStats.totalReservations--;
+    if (reservation->prev == NULL) {
+        reservationList = reservation->next;
+    } else {
+        reservation->prev->next = reservation->next;
+    }
+    if (reservation->next != NULL) {
+        reservation->next->prev = reservation->prev;
+    }
+    
+    // A reservation is on its owner's chain exactly when the owner exists
+    User* owner = findUser(reservation->username);
+    if (owner != NULL) {
+        unlinkUserReservation(owner, reservation);
+    } else {
+        orphanReservations--;
+    }
+    poolFree(&reservationPool, reservation);
+}
+
+// Find a reservation by room and check-in; bookings in a room never overlap
+Reservation* findReservation(int roomNumber, int checkInDay, int checkInMinute) {
+    RoomBookings* bookings = getRoomBookings(roomNumber, 0);
+    if (bookings == NULL) {
+        return NULL;
+    }
+    
+    int pos = findBookingPosition(bookings, checkInDay);
+    while (pos > 0 && bookings->items[pos - 1]->checkInDay == checkInDay) {
+        pos--;
+        if (bookings->items[pos]->checkInMinute == checkInMinute) {
+            return bookings->items[pos];
+        }
+    }
+    return NULL;
+}
+
+// Find the reservation in a room that matches every field of a stay. Unlike
+// findReservation it stays exact while a replayed move has two stays
+// overlapping in one room.
+Reservation* findExactReservation(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    RoomBookings* bookings = getRoomBookings(roomNumber, 0);
+    if (bookings == NULL) {
+        return NULL;
+    }
+    
+    int pos = findBookingPosition(bookings, checkInDay);
+    while (pos > 0 && bookings->items[pos - 1]->checkInDay == checkInDay) {
+        Reservation* reservation = bookings->items[--pos];
+        if (reservation->checkInMinute == checkInMinute && reservation->checkOutDay == checkOutDay &&
+            reservation->checkOutMinute == checkOutMinute && strcmp(reservation->username, username) == 0) {
+            return reservation;
+        }
+    }
+    return NULL;
+}
+
+// Append a reservation as the last row of the column store. The columns
+// always hold whole blocks of SCAN_BLOCK rows; the rows past count are
+// tombstones, so every scan loop runs a fixed number of times.
+void addReservationRow(Reservation* reservation) {
+    ReservationColumns* columns = &reservationColumns;
+    
+    if (columns->count == columns->capacity) {
+        int oldCapacity = columns->capacity;
+        columns->capacity = columns->capacity > 0 ? columns->capacity * 2 : 4 * SCAN_BLOCK;
+        columns->roomNumbers = (int*)realloc(columns->roomNumbers, columns->capacity * sizeof(int));
+        columns->checkInStamps = (int*)realloc(columns->checkInStamps, columns->capacity * sizeof(int));
+        columns->checkOutStamps = (int*)realloc(columns->checkOutStamps, columns->capacity * sizeof(int));
+        columns->userIds = (int*)realloc(columns->userIds, columns->capacity * sizeof(int));
+        columns->items = (Reservation**)realloc(columns->items, columns->capacity * sizeof(Reservation*));
+        clearReservationRows(oldCapacity, columns->capacity);
+    }
+    
+    reservation->columnRow = columns->count++;
+    columns->items[reservation->columnRow] = reservation;
+    columns->userIds[reservation->columnRow] = 0;
+    updateReservationRow(reservation);
+}
+
+// Rewrite the row after the reservation's room or dates changed
+void updateReservationRow(Reservation* reservation) {
+    int row = reservation->columnRow;
+    reservationColumns.roomNumbers[row] = reservation->roomNumber;
+    reservationColumns.checkInStamps[row] = dateStamp(reservation->checkInDay, reservation->checkInMinute);
+    reservationColumns.checkOutStamps[row] = dateStamp(reservation->checkOutDay, reservation->checkOutMinute);
+}
+
+// Leave a tombstone in the reservation's row. The table is compacted once
+// tombstones make up a quarter of it, so scans never read mostly dead rows.
+void removeReservationRow(Reservation* reservation) {
+    ReservationColumns* columns = &reservationColumns;
+    
+    clearReservationRows(reservation->columnRow, reservation->columnRow + 1);
+    columns->tombstones++;
+    if (columns->tombstones >= SCAN_BLOCK && columns->tombstones * 4 >= columns->count) {
+        compactReservationColumns();
+    }
+}
+
+// Close up the tombstones, keeping live rows in the order they were added
+void compactReservationColumns() {
+    ReservationColumns* columns = &reservationColumns;
+    int live = 0;
+    int row;
+    
+    for (row = 0; row < columns->count; row++) {
+        if (columns->items[row] == NULL) {
+            continue;
+        }
+        columns->items[live] = columns->items[row];
+        columns->roomNumbers[live] = columns->roomNumbers[row];
+        columns->checkInStamps[live] = columns->checkInStamps[row];
+        columns->checkOutStamps[live] = columns->checkOutStamps[row];
+        columns->userIds[live] = columns->userIds[row];
+        columns->items[live]->columnRow = live;
+        live++;
+    }
+    clearReservationRows(live, columns->count);
+    columns->count = live;
+    columns->tombstones = 0;
+}
+
+// Make rows first..last-1 tombstones: room 0 and a stay that ends before it starts
+void clearReservationRows(int first, int last) {
+    int row;
+    for (row = first; row < last; row++) {
+        reservationColumns.items[row] = NULL;
+        reservationColumns.roomNumbers[row] = 0;
+        reservationColumns.checkInStamps[row] = INT_MAX;
+        reservationColumns.checkOutStamps[row] = INT_MIN;
+        reservationColumns.userIds[row] = 0;
+    }
+}
+
+// Collect the reservations a filter matches, in the order they were added.
+// Returns how many match, which may be more than maxResults.
+int scanReservations(const ReservationFilter* filter, Reservation* results[], int maxResults) {
+    unsigned long long start = metricsClock();
+    unsigned char match[SCAN_BLOCK];
+    int found = 0;
+    int first, i;
+    
+    for (first = 0; first < reservationColumns.count; first += SCAN_BLOCK) {
+        if (matchReservationBlock(filter, first, match) == 0) {
+            continue;
+        }
+        for (i = 0; i < SCAN_BLOCK; i++) {
+            if (match[i]) {
+                if (found < maxResults) {
+                    results[found] = reservationColumns.items[first + i];
+                }
+                found++;
+            }
+        }
+    }
+    
+    metricsRecord(METRIC_SCAN, start);
+    return found;
+}
+
+int countReservations(const ReservationFilter* filter) {
+    unsigned long long start = metricsClock();
+    unsigned char match[SCAN_BLOCK];
+    int found = 0;
+    int first;
+    
+    for (first = 0; first < reservationColumns.count; first += SCAN_BLOCK) {
+        found += matchReservationBlock(filter, first, match);
+    }
+    
+    metricsRecord(METRIC_SCAN, start);
+    return found;
+}
+
+// Test the SCAN_BLOCK rows from first against the filter, setting match[i]
+// to 0 or 1. The loop has a fixed trip count, no branches and reads each
+// column in order, so the compiler turns it into vector compares even at
+// -O2. Returns the number of matches.
+int matchReservationBlock(const ReservationFilter* filter, int first, unsigned char match[]) {
+    const int* roomNumbers = reservationColumns.roomNumbers + first;
+    const int* checkInStamps = reservationColumns.checkInStamps + first;
+    const int* checkOutStamps = reservationColumns.checkOutStamps + first;
+    const int* userIds = reservationColumns.userIds + first;
+    int fromStamp = dateStamp(filter->fromDay, 0);
+    int toStamp = dateStamp(filter->toDay, 0);
+    int roomNumber = filter->roomNumber;
+    int userId = filter->userId;
+    int anyRoom = roomNumber == 0;
+    int anyUser = userId == 0;
+    unsigned char hits[SCAN_BLOCK];  // Local, so the stores cannot alias the columns
+    int matches = 0;
+    int i;
+    
+    for (i = 0; i < SCAN_BLOCK; i++) {
+        int hit = (checkInStamps[i] < toStamp) & (checkOutStamps[i] > fromStamp) &
+                  (anyRoom | (roomNumbers[i] == roomNumber)) & (anyUser | (userIds[i] == userId));
+        hits[i] = (unsigned char)hit;
+        matches += hit;
+    }
+    memcpy(match, hits, SCAN_BLOCK);
+    return matches;
+}
+
+// Minutes since 1970-01-01, so a date and time compare as one integer
+int dateStamp(int day, int minute) {
+    return day * MINUTES_PER_DAY + minute;
+}
+
+// Make space for one more room in rooms and roomBookings
+void resizeRooms() {
+    if (totalRooms >= maxRooms) {
+        maxRooms = maxRooms > 0 ? maxRooms * 2 : 16;
+        rooms = (Room*)realloc(rooms, maxRooms * sizeof(Room));
+        roomBookings = (RoomBookings*)realloc(roomBookings, maxRooms * sizeof(RoomBookings));
+    }
+}
+
+// Delete a user together with all of their reservations
+void removeUser(User* user) {
+    while (user->reservations != NULL) {
+        deleteReservation(user->reservations);
+    }
+    
+    removeUserIndex(user);
+    if (user->prev == NULL) {
+        userList = user->next;
+    } else {
+        user->prev->next = user->next;
+    }
+    if (user->next != NULL) {
+        user->next->prev = user->prev;
+    }
+    
+    poolFree(&userPool, user);
+}
+
+void cleanup() {
+    // Nodes live in the pools, so the lists are released chunk by chunk
+    poolRelease(&userPool);
+    userList = NULL;
+    nextUserId = 1;
+    
+    free(userTable);
+    userTable = NULL;
+    userTableCapacity = 0;
+    userTableCount = 0;
+    
+    poolRelease(&reservationPool);
+    reservationList = NULL;
+    orphanReservations = 0;
+    
+    free(reservationColumns.roomNumbers);
+    free(reservationColumns.checkInStamps);
+    free(reservationColumns.checkOutStamps);
+    free(reservationColumns.userIds);
+    free(reservationColumns.items);
+    memset(&reservationColumns, 0, sizeof(reservationColumns));
+    
+    free(expiryHeap);
+    expiryHeap = NULL;
+    expiryHeapSize = 0;
+    expiryHeapCapacity = 0;
+    
+    int i;
+    for (i = 0; i < totalRooms; i++) {
+        free(roomBookings[i].items);
+    }
+    free(roomBookings);
+    roomBookings = NULL;
+    
+    free(roomTable);
+    roomTable = NULL;
+    roomTableCapacity = 0;
+    
+    free(rooms);
+    rooms = NULL;
+    totalRooms = 0;
+    maxRooms = 0;
+    
+    for (i = 0; i < roomTypeCount; i++) {
+        free(roomTypes[i].roomSlots);
+    }
+    free(roomTypes);
+    roomTypes = NULL;
+    roomTypeCount = 0;
+    roomTypeCapacity = 0;
+    
+    free(hotelStats.types);
+    memset(&hotelStats, 0, sizeof(hotelStats));
+    freeNightLedgers();
+}
+
+void* poolAlloc(MemoryPool* pool) {
+    if (pool->freeList == NULL) {
+        PoolChunk* chunk = (PoolChunk*)malloc(sizeof(PoolChunk) + pool->itemSize * pool->itemsPerChunk);
+        char* items = (char*)(chunk + 1);
+        int i;
+        
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->chunkCount++;
+        
+        // Thread the free list back to front so items are handed out in address order
+        for (i = pool->itemsPerChunk - 1; i >= 0; i--) {
+            void** item = (void**)(items + i * pool->itemSize);
+            *item = pool->freeList;
+            pool->freeList = item;
+        }
+    }
+    
+    void** item = (void**)pool->freeList;
+    pool->freeList = *item;
+    pool->inUse++;
+    return item;
+}
+
+void poolFree(MemoryPool* pool, void* item) {
+    *(void**)item = pool->freeList;
+    pool->freeList = item;
+    pool->inUse--;
+}
+
+void poolRelease(MemoryPool* pool) {
+    while (pool->chunks != NULL) {
+        PoolChunk* next = pool->chunks->next;
+        free(pool->chunks);
+        pool->chunks = next;
+    }
+    pool->freeList = NULL;
+    pool->chunkCount = 0;
+    pool->inUse = 0;
+}
+
+// Write a full snapshot of users, reservations and rooms (a checkpoint)
+int saveData() {
+    SnapshotImage image;
+    if (!captureSnapshot(&image)) {
+        return 0;
+    }
+    unsigned long long sequence = image.sequence;
+    if (!writeSnapshot(&image)) {
+        return 0;
+    }
+    markSnapshotDurable(sequence);
+    return 1;
+}
+
+// First half of a checkpoint, run with the engine held still: encode the
+// state in memory and start a new journal segment. Mutations may go on as
+// soon as this returns; writeSnapshot does the slow part.
+// Returns 0, with nothing captured, if the journal segment could not be closed.
+int captureSnapshot(SnapshotImage* image) {
+    unsigned long long start = metricsClock();
+    
+    if (!journalOpen) {
+        journalSegment++;
+    } else if (!rotateJournal()) {
+        memset(image, 0, sizeof(*image));
+        metricsRecord(METRIC_SNAPSHOT_CAPTURE, start);
+        return 0;
+    }
+    buildSnapshotImage(image);
+    image->sequence = journalSequence;
+    journalRecordsSinceSnapshot = 0;
+    journalBytesSinceSnapshot = 0;
+    
+    metricsRecord(METRIC_SNAPSHOT_CAPTURE, start);
+    return 1;
+}
+
+// Second half of a checkpoint. Reads nothing but the image, so it may run
+// on another thread while the engine keeps changing. Frees the image.
+int writeSnapshot(SnapshotImage* image) {
+    unsigned long long start = metricsClock();
+    int success = writeSnapshotImage(image, snapshotFilePath);
+    
+    // The snapshot now covers the closed journal segment
+    if (success) {
+        remove(oldJournalFilePath);
+    }
+    freeSnapshotImage(image);
+    
+    metricsRecord(METRIC_SAVE, start);
+    return success;
+}
+
+// A snapshot on disk holds every record up to sequence, so a failed journal
+// write before it no longer leaves anything behind. Call with the engine held.
+void markSnapshotDurable(unsigned long long sequence) {
+    if (sequence > journalDurableSequence) {
+        journalDurableSequence = sequence;
+    }
+}
+
+// Whether enough has been journaled since the last checkpoint to take
+// another, or a failed journal write is waiting for one to cover it
+int snapshotDue() {
+    return journalFailedSequence > journalDurableSequence ||
+           (snapshotEveryRecords > 0 && journalRecordsSinceSnapshot >= snapshotEveryRecords) ||
+           (snapshotEveryBytes > 0 && journalBytesSinceSnapshot >= snapshotEveryBytes);
+}
+
+// Checkpoint after this many journal records or bytes; 0 turns a trigger off
+void hotelSetSnapshotTriggers(unsigned long long everyRecords, unsigned long long everyBytes) {
+    snapshotEveryRecords = everyRecords;
+    snapshotEveryBytes = everyBytes;
+}
+
+// Write the snapshot in the USER:/RESERVATION:/ROOM: text format
+int saveTextSnapshot(const char path[]) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    
+    // Save users
+    User* currentUser = userList;
+    while (currentUser != NULL) {
+        fprintf(file, "USER:%s:%s:%d\n", currentUser->username, currentUser->password, currentUser->isAdmin);
+        currentUser = currentUser->next;
+    }
+    
+    // Save reservations
+    Reservation* currentReservation = reservationList;
+    char checkInDate[11], checkInTime[6], checkOutDate[11], checkOutTime[6];
+    while (currentReservation != NULL) {
+        dayToDate(currentReservation->checkInDay, checkInDate);
+        minuteToTime(currentReservation->checkInMinute, checkInTime);
+        dayToDate(currentReservation->checkOutDay, checkOutDate);
+        minuteToTime(currentReservation->checkOutMinute, checkOutTime);
+        fprintf(file, "RESERVATION:%s:%d:%s:%s:%s:%s\n", 
+                currentReservation->username, 
+                currentReservation->roomNumber, 
+                checkInDate, 
+                checkInTime, 
+                checkOutDate, 
+                checkOutTime);
+        currentReservation = currentReservation->next;
+    }
+    
+    // Save room information
+    int i;
+    for (i = 0; i < totalRooms; i++) {
+        fprintf(file, "ROOM:%d:%s:%.2f\n", 
+                rooms[i].roomNumber, 
+                roomTypes[rooms[i].typeId].name, 
+                roomTypes[rooms[i].typeId].pricePerNight);
+    }
+    
+    fclose(file);
+    return 1;
+}
+
+// Read a snapshot in the USER:/RESERVATION:/ROOM: text format. The file is
+// mapped and cut into newline-aligned chunks that are tokenized in parallel;
+// the records are then applied on this thread in file order, so the result
+// does not depend on how the file was split.
+int loadTextSnapshot(const char path[]) {
+    MappedFile mapped;
+    TextChunk chunks[LOADER_MAX_THREADS];
+    int started[LOADER_MAX_THREADS];
+#ifdef _WIN32
+    HANDLE threads[LOADER_MAX_THREADS];
+#else
+    pthread_t threads[LOADER_MAX_THREADS];
+#endif
+    int i, j;
+    
+    if (!mapFile(path, &mapped)) {
+        // A missing file is not an error, and an empty one holds nothing
+        FILE* file = fopen(path, "r");
+        if (file == NULL) {
+            return 0;
+        }
+        fclose(file);
+        return 1;
+    }
+    
+    const char* data = (const char*)mapped.data;
+    const char* fileEnd = data + mapped.size;
+    int chunkCount = countLoaderThreads(mapped.size);
+    const char* start = data;
+    for (i = 0; i < chunkCount; i++) {
+        const char* end = i + 1 < chunkCount ? data + mapped.size / chunkCount * (i + 1) : fileEnd;
+        if (end < start) {
+            end = start;
+        }
+        // Move the cut past the end of the line it falls in
+        if (end < fileEnd && end > data && end[-1] != '\n') {
+            const char* newline = (const char*)memchr(end, '\n', fileEnd - end);
+            end = newline != NULL ? newline + 1 : fileEnd;
+        }
+        
+        memset(&chunks[i], 0, sizeof(TextChunk));
+        chunks[i].start = start;
+        chunks[i].end = end;
+        start = end;
+    }
+    
+    // The first chunk is parsed here while the others run on their own threads
+    for (i = 1; i < chunkCount; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, parseTextChunk, &chunks[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = pthread_create(&threads[i], NULL, parseTextChunk, &chunks[i]) == 0;
+#endif
+    }
+    parseTextChunk(&chunks[0]);
+    for (i = 1; i < chunkCount; i++) {
+        if (!started[i]) {
+            parseTextChunk(&chunks[i]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    
+    int failed = 0;
+    for (i = 0; i < chunkCount; i++) {
+        failed |= chunks[i].failed;
+    }
+    for (i = 0; i < chunkCount; i++) {
+        for (j = 0; j < chunks[i].count && !failed; j++) {
+            applyTextRecord(&chunks[i].records[j]);
+        }
+        free(chunks[i].records);
+    }
+    
+    unmapFile(&mapped);
+    return !failed;
+}
+
+// One thread per processor, but no more than the file has chunks of
+// LOADER_CHUNK_BYTES for
+int countLoaderThreads(size_t size) {
+    int count = loaderThreads;
+    
+    if (count <= 0) {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        count = (int)info.dwNumberOfProcessors;
+#else
+        count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if ((size_t)count > size / LOADER_CHUNK_BYTES) {
+            count = (int)(size / LOADER_CHUNK_BYTES);
+        }
+    }
+    if (count > LOADER_MAX_THREADS) {
+        count = LOADER_MAX_THREADS;
+    }
+    return count > 0 ? count : 1;
+}
+
+// Tokenize every line of a chunk. Touches nothing outside the chunk, so
+// chunks of the same file can be parsed at the same time.
+#ifdef _WIN32
+DWORD WINAPI parseTextChunk(LPVOID argument) {
+#else
+void* parseTextChunk(void* argument) {
+#endif
+    TextChunk* chunk = (TextChunk*)argument;
+    const char* line = chunk->start;
+    
+    while (line < chunk->end) {
+        const char* newline = (const char*)memchr(line, '\n', chunk->end - line);
+        const char* end = newline != NULL ? newline : chunk->end;
+        
+        if (chunk->count == chunk->capacity) {
+            int capacity = chunk->capacity > 0 ? chunk->capacity * 2 : 1024;
+            TextRecord* records = (TextRecord*)realloc(chunk->records, capacity * sizeof(TextRecord));
+            if (records == NULL) {
+                chunk->failed = 1;
+                break;
+            }
+            chunk->records = records;
+            chunk->capacity = capacity;
+        }
+        int parsed = parseTextRecord(line, end, &chunk->records[chunk->count]);
+        if (parsed < 0) {
+            chunk->failed = 1;
+            break;
+        }
+        chunk->count += parsed;
+        line = end + 1;
+    }
+    return 0;
+}
+
+// Split one line into its fields. Returns 0 for unknown or malformed lines
+// and for names too long to store, and -1 for a reservation whose dates or
+// times are not real ones, which means the file is damaged.
+int parseTextRecord(const char* line, const char* end, TextRecord* record) {
+    const char* fields[9];
+    int lengths[9];
+    int count = 0;
+    
+    if (end > line && end[-1] == '\r') {
+        end--;
+    }
+    while (count < 9 && (fields[count] = nextTextField(&line, end, &lengths[count])) != NULL) {
+        count++;
+    }
+    if (count == 0 || nextTextField(&line, end, &lengths[0]) != NULL) {
+        return 0;
+    }
+    
+    if (count == 4 && lengths[0] == 4 && memcmp(fields[0], "USER", 4) == 0) {
+        record->kind = TEXT_USER;
+        record->name = fields[1];
+        record->nameLength = lengths[1];
+        record->password = fields[2];
+        record->passwordLength = lengths[2];
+        return lengths[1] > 0 && lengths[1] < MAX_NAME_LEN && lengths[2] > 0 && lengths[2] < MAX_PASSWORD_LEN &&
+               parseTextInt(fields[3], lengths[3], &record->number);
+    }
+    
+    // Times are written as HH:MM, so each one spans two ':'-separated fields
+    if (count == 9 && lengths[0] == 11 && memcmp(fields[0], "RESERVATION", 11) == 0) {
+        record->kind = TEXT_RESERVATION;
+        record->name = fields[1];
+        record->nameLength = lengths[1];
+        if (!(lengths[1] > 0 && lengths[1] < MAX_NAME_LEN && parseTextInt(fields[2], lengths[2], &record->number))) {
+            return 0;
+        }
+        return parseTextDate(fields[3], lengths[3], &record->checkInDay) &&
+               parseTextMinute(fields[4], lengths[4], fields[5], lengths[5], &record->checkInMinute) &&
+               parseTextDate(fields[6], lengths[6], &record->checkOutDay) &&
+               parseTextMinute(fields[7], lengths[7], fields[8], lengths[8], &record->checkOutMinute) ? 1 : -1;
+    }
+    
+    if (count == 4 && lengths[0] == 4 && memcmp(fields[0], "ROOM", 4) == 0) {
+        char price[32];
+        char* priceEnd;
+        
+        record->kind = TEXT_ROOM;
+        record->name = fields[2];
+        record->nameLength = lengths[2];
+        if (!parseTextInt(fields[1], lengths[1], &record->number) ||
+            lengths[2] == 0 || lengths[2] >= MAX_ROOM_TYPE_LEN || lengths[3] == 0 || lengths[3] >= (int)sizeof(price)) {
+            return 0;
+        }
+        memcpy(price, fields[3], lengths[3]);
+        price[lengths[3]] = '\0';
+        record->pricePerNight = strtod(price, &priceEnd);
+        return *priceEnd == '\0';
+    }
+    
+    return 0;
+}
+
+// Return the field at *cursor and move past its ':'. NULL once the line is used up.
+const char* nextTextField(const char** cursor, const char* end, int* length) {
+    const char* field = *cursor;
+    
+    if (field > end) {
+        return NULL;
+    }
+    const char* colon = (const char*)memchr(field, ':', end - field);
+    const char* fieldEnd = colon != NULL ? colon : end;
+    *length = (int)(fieldEnd - field);
+    *cursor = fieldEnd + 1;
+    return field;
+}
+
+int parseTextInt(const char* text, int length, int* value) {
+    int negative = length > 0 && text[0] == '-';
+    int result = 0;
+    int i;
+    
+    if (length - negative < 1 || length - negative > 9) {
+        return 0;
+    }
+    for (i = negative; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return 0;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// YYYY-MM-DD naming a real day, as isValidDate would accept it
+int parseTextDate(const char* text, int length, int* day) {
+    int i;
+    
+    if (length != 10) {
+        return 0;
+    }
+    for (i = 0; i < 10; i++) {
+        int isDash = i == 4 || i == 7;
+        if (isDash ? text[i] != '-' : (text[i] < '0' || text[i] > '9')) {
+            return 0;
+        }
+    }
+    int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10 + (text[3] - '0');
+    int month = (text[5] - '0') * 10 + (text[6] - '0');
+    int dayOfMonth = (text[8] - '0') * 10 + (text[9] - '0');
+    if (month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > monthLength(year, month)) {
+        return 0;
+    }
+    *day = daysFromCivil(year, month, dayOfMonth);
+    return 1;
+}
+
+// HH and MM of a time of day, as isValidTime would accept them
+int parseTextMinute(const char* hourText, int hourLength, const char* minuteText, int minuteLength, short* minute) {
+    int hour, minuteOfHour;
+    
+    if (hourLength != 2 || minuteLength != 2 || !parseTextInt(hourText, hourLength, &hour) ||
+        !parseTextInt(minuteText, minuteLength, &minuteOfHour) || hour < 0 || hour > 23 || minuteOfHour < 0 ||
+        minuteOfHour > 59) {
+        return 0;
+    }
+    *minute = (short)(hour * 60 + minuteOfHour);
+    return 1;
+}
+
+// Hand a parsed line to the engine, the way reading it directly would
+void applyTextRecord(const TextRecord* record) {
+    char name[MAX_NAME_LEN];
+    char password[MAX_PASSWORD_LEN];
+    char roomType[MAX_ROOM_TYPE_LEN];
+    
+    if (record->kind == TEXT_ROOM) {
+        memcpy(roomType, record->name, record->nameLength);
+        roomType[record->nameLength] = '\0';
+        restoreRoom(record->number, roomType, record->pricePerNight);
+        return;
+    }
+    
+    memcpy(name, record->name, record->nameLength);
+    name[record->nameLength] = '\0';
+    if (record->kind == TEXT_USER) {
+        memcpy(password, record->password, record->passwordLength);
+        password[record->passwordLength] = '\0';
+        addUser(name, password, record->number);
+    } else {
+        addReservation(name, record->number, record->checkInDay, record->checkInMinute,
+                       record->checkOutDay, record->checkOutMinute);
+    }
+}
+
+void loadData() {
+    unsigned long long start = metricsClock();
+    int i;
+    
+    // Older installs only have the text snapshot; it is converted on the next save
+    freeRunsDeferred = 1;
+    if (!loadBinarySnapshot(snapshotFilePath)) {
+        loadTextSnapshot(textFilePath);
+    }
+    
+    // Apply the mutations made since that snapshot was written
+    replayJournal();
+    
+    // One pass per room instead of one per stay
+    freeRunsDeferred = 0;
+    for (i = 0; i < totalRooms; i++) {
+        buildFreeRuns(&roomBookings[i]);
+    }
+    metricsRecord(METRIC_LOAD, start);
+}
+
+// FNV-1a over a block of bytes, continuing from a previous hash value
+unsigned int snapshotChecksum(unsigned int hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+unsigned int addSnapshotString(StringTable* table, const char text[]) {
+    unsigned int length = (unsigned int)strlen(text) + 1;
+    if (table->size + length > table->capacity) {
+        while (table->size + length > table->capacity) {
+            table->capacity = table->capacity > 0 ? table->capacity * 2 : 4096;
+        }
+        table->data = (char*)realloc(table->data, table->capacity);
+    }
+    
+    unsigned int offset = table->size;
+    memcpy(table->data + offset, text, length);
+    table->size += length;
+    return offset;
+}
+
+int saveBinarySnapshot(const char path[]) {
+    SnapshotImage image;
+    
+    buildSnapshotImage(&image);
+    int success = writeSnapshotImage(&image, path);
+    freeSnapshotImage(&image);
+    return success;
+}
+
+// Encode rooms, users and reservations in the snapshot file layout
+void buildSnapshotImage(SnapshotImage* image) {
+    SnapshotHeader header;
+    StringTable strings = { NULL, 0, 0 };
+    int i;
+    
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.roomCount = totalRooms;
+    header.userCount = userTableCount;
+    header.reservationCount = reservationPool.inUse;
+    header.journalSegment = journalSegment;
+    
+    // Header and record arrays share one block, laid out as in the file
+    size_t roomsStart = sizeof(header);
+    size_t usersStart = roomsStart + (size_t)header.roomCount * sizeof(SnapshotRoom);
+    size_t reservationsStart = usersStart + (size_t)header.userCount * sizeof(SnapshotUser);
+    unsigned char* records = (unsigned char*)calloc(reservationsStart + ((size_t)header.reservationCount + 1) * sizeof(SnapshotReservation), 1);
+    SnapshotRoom* roomRecords = (SnapshotRoom*)(records + roomsStart);
+    SnapshotUser* userRecords = (SnapshotUser*)(records + usersStart);
+    SnapshotReservation* reservationRecords = (SnapshotReservation*)(records + reservationsStart);
+    // Username offsets by user table slot, so reservations share the user's string
+    unsigned int* usernameOffsets = (unsigned int*)malloc((userTableCapacity + 1) * sizeof(unsigned int));
+    
+    for (i = 0; i < totalRooms; i++) {
+        roomRecords[i].roomNumber = rooms[i].roomNumber;
+        roomRecords[i].roomTypeOffset = addSnapshotString(&strings, roomTypes[rooms[i].typeId].name);
+        roomRecords[i].pricePerNight = roomTypes[rooms[i].typeId].pricePerNight;
+    }
+    
+    User* currentUser = userList;
+    i = 0;
+    while (currentUser != NULL) {
+        userRecords[i].usernameOffset = addSnapshotString(&strings, currentUser->username);
+        userRecords[i].passwordOffset = addSnapshotString(&strings, currentUser->password);
+        userRecords[i].isAdmin = currentUser->isAdmin;
+        usernameOffsets[findUserSlot(currentUser->username)] = userRecords[i].usernameOffset;
+        currentUser = currentUser->next;
+        i++;
+    }
+    
+    // Write reservations room by room in check-in order so loading appends to each room index
+    int count = 0;
+    int room;
+    for (room = 0; room < totalRooms; room++) {
+        int j;
+        for (j = 0; j < roomBookings[room].count; j++) {
+            Reservation* reservation = roomBookings[room].items[j];
+            SnapshotReservation* record = &reservationRecords[count++];
+            int slot = findUserSlot(reservation->username);
+            
+            record->usernameOffset = slot >= 0 ? usernameOffsets[slot] : addSnapshotString(&strings, reservation->username);
+            record->roomNumber = reservation->roomNumber;
+            record->checkInDay = reservation->checkInDay;
+            record->checkOutDay = reservation->checkOutDay;
+            record->checkInMinute = reservation->checkInMinute;
+            record->checkOutMinute = reservation->checkOutMinute;
+            record->locked = reservation->locked;
+        }
+    }
+    header.reservationCount = count;
+    header.stringTableSize = strings.size;
+    
+    // The checksum is left to writeSnapshotImage, outside the engine lock
+    memcpy(records, &header, sizeof(header));
+    image->records = records;
+    image->recordsSize = reservationsStart + (size_t)count * sizeof(SnapshotReservation);
+    image->strings = strings.data;
+    image->stringsSize = strings.size;
+    free(usernameOffsets);
+}
+
+// Checksum an image and write it to path through a temporary file that is
+// renamed into place, so a crash leaves either the old snapshot or the new one
+int writeSnapshotImage(SnapshotImage* image, const char path[]) {
+    char temporaryPath[MAX_PATH_LEN + 4];
+    SnapshotHeader* header = (SnapshotHeader*)image->records;
+    int success = 0;
+    
+    header->checksum = snapshotChecksum(2166136261u, image->records + sizeof(SnapshotHeader),
+                                        image->recordsSize - sizeof(SnapshotHeader));
+    header->checksum = snapshotChecksum(header->checksum, image->strings, image->stringsSize);
+    
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+    FILE* file = fopen(temporaryPath, "wb");
+    if (file == NULL) {
+        return 0;
+    }
+    fwrite(image->records, 1, image->recordsSize, file);
+    fwrite(image->strings, 1, image->stringsSize, file);
+    success = fflush(file) == 0 && !ferror(file) && fsync(fileno(file)) == 0;
+    fclose(file);
+    
+    success = success && replaceFile(temporaryPath, path);
+    if (!success) {
+        remove(temporaryPath);
+        return 0;
+    }
+    
+    unsigned long long bytes = image->recordsSize + image->stringsSize;
+    metricsAdd(COUNTER_SAVE_BYTES, bytes);
+    metricsSet(COUNTER_LAST_SAVE_BYTES, bytes);
+    return 1;
+}
+
+// Move a fully written file over path in one step
+int replaceFile(const char temporaryPath[], const char path[]) {
+#ifdef _WIN32
+    return MoveFileExA(temporaryPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(temporaryPath, path) == 0;
+#endif
+}
+
+void freeSnapshotImage(SnapshotImage* image) {
+    free(image->records);
+    free(image->strings);
+    memset(image, 0, sizeof(*image));
+}
+
+int mapFile(const char path[], MappedFile* mapped) {
+    memset(mapped, 0, sizeof(*mapped));
+#ifdef _WIN32
+    mapped->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapped->file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped->file, &size) || size.QuadPart == 0) {
+        CloseHandle(mapped->file);
+        return 0;
+    }
+    mapped->size = (size_t)size.QuadPart;
+    
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapped->mapping == NULL) {
+        CloseHandle(mapped->file);
+        return 0;
+    }
+    
+    mapped->data = (const unsigned char*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapped->data == NULL) {
+        CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        return 0;
+    }
+#else
+    struct stat info;
+    mapped->fd = open(path, O_RDONLY);
+    if (mapped->fd < 0) {
+        return 0;
+    }
+    
+    if (fstat(mapped->fd, &info) != 0 || info.st_size == 0) {
+        close(mapped->fd);
+        return 0;
+    }
+    mapped->size = (size_t)info.st_size;
+    
+    void* data = mmap(NULL, mapped->size, PROT_READ, MAP_PRIVATE, mapped->fd, 0);
+    if (data == MAP_FAILED) {
+        close(mapped->fd);
+        return 0;
+    }
+    mapped->data = (const unsigned char*)data;
+#endif
+    return 1;
+}
+
+void unmapFile(MappedFile* mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile((LPCVOID)mapped->data);
+    CloseHandle(mapped->mapping);
+    CloseHandle(mapped->file);
+#else
+    munmap((void*)mapped->data, mapped->size);
+    close(mapped->fd);
+#endif
+    mapped->data = NULL;
+}
+
+// Resolve a string table offset, rejecting strings that run off the table or are too long
+const char* getSnapshotString(const MappedFile* mapped, unsigned int tableStart, unsigned int tableSize, unsigned int offset, size_t maxLen) {
+    if (offset >= tableSize) {
+        return NULL;
+    }
+    
+    const char* text = (const char*)mapped->data + tableStart + offset;
+    size_t limit = tableSize - offset < maxLen ? tableSize - offset : maxLen;
+    if (memchr(text, '\0', limit) == NULL) {
+        return NULL;
+    }
+    return text;
+}
+
+// Map a binary snapshot and build the in-memory structures from it.
+// Returns 0 if the file is missing or fails validation.
+int loadBinarySnapshot(const char path[]) {
+    MappedFile mapped;
+    SnapshotHeader header;
+    unsigned int i;
+    
+    if (!mapFile(path, &mapped)) {
+        return 0;
+    }
+    
+    if (mapped.size < sizeof(header)) {
+        unmapFile(&mapped);
+        return 0;
+    }
+    memcpy(&header, mapped.data, sizeof(header));
+    
+    // Version 1 snapshots are read as if every reservation were locked
+    size_t reservationSize = header.version == 1 ? SNAPSHOT_V1_RESERVATION_SIZE : sizeof(SnapshotReservation);
+    size_t roomsStart = sizeof(header);
+    size_t usersStart = roomsStart + (size_t)header.roomCount * sizeof(SnapshotRoom);
+    size_t reservationsStart = usersStart + (size_t)header.userCount * sizeof(SnapshotUser);
+    size_t stringsStart = reservationsStart + (size_t)header.reservationCount * reservationSize;
+    
+    if (header.magic != SNAPSHOT_MAGIC || (header.version != 1 && header.version != SNAPSHOT_VERSION) ||
+        stringsStart + header.stringTableSize != mapped.size ||
+        snapshotChecksum(2166136261u, mapped.data + roomsStart, mapped.size - roomsStart) != header.checksum) {
+        unmapFile(&mapped);
+        return 0;
+    }
+    
+    journalSegment = header.journalSegment;
+    const SnapshotRoom* roomRecords = (const SnapshotRoom*)(mapped.data + roomsStart);
+    const SnapshotUser* userRecords = (const SnapshotUser*)(mapped.data + usersStart);
+    SnapshotReservation record;
+    unsigned int tableStart = (unsigned int)stringsStart;
+    unsigned int tableSize = header.stringTableSize;
+    
+    for (i = 0; i < header.roomCount; i++) {
+        const char* roomType = getSnapshotString(&mapped, tableStart, tableSize, roomRecords[i].roomTypeOffset, MAX_ROOM_TYPE_LEN);
+        if (roomType != NULL) {
+            restoreRoom(roomRecords[i].roomNumber, (char*)roomType, roomRecords[i].pricePerNight);
+        }
+    }
+    
+    for (i = 0; i < header.userCount; i++) {
+        const char* username = getSnapshotString(&mapped, tableStart, tableSize, userRecords[i].usernameOffset, MAX_NAME_LEN);
+        const char* password = getSnapshotString(&mapped, tableStart, tableSize, userRecords[i].passwordOffset, MAX_PASSWORD_LEN);
+        if (username != NULL && password != NULL) {
+            addUser((char*)username, (char*)password, userRecords[i].isAdmin);
+        }
+    }
+    
+    record.locked = 1;
+    for (i = 0; i < header.reservationCount; i++) {
+        memcpy(&record, mapped.data + reservationsStart + i * reservationSize, reservationSize);
+        const char* username = getSnapshotString(&mapped, tableStart, tableSize, record.usernameOffset, MAX_NAME_LEN);
+        if (username != NULL) {
+            addReservation((char*)username, record.roomNumber, record.checkInDay, record.checkInMinute,
+                           record.checkOutDay, record.checkOutMinute)->locked = record.locked;
+        }
+    }
+    
+    unmapFile(&mapped);
+    return 1;
+}
+
+// Create a room or move it to another type. pricePerNight only applies if
+// the type is new; rates of known types change through setRoomTypeRate.
+void setRoom(int roomNumber, char roomType[], double pricePerNight) {
+    if (roomNumber < 1) {
+        return;
+    }
+    
+    int typeId = defineRoomType(roomType, pricePerNight);
+    int slot = findRoomSlot(roomNumber);
+    if (slot < 0) {
+        insertRoom(roomNumber, typeId);
+        return;
+    }
+    
+    countRoomStats(roomNumber, -1);
+    if (rooms[slot].typeId != typeId) {
+        // The room's nights are now sold as the new type
+        int i;
+        for (i = 0; i < roomBookings[slot].count; i++) {
+            Reservation* reservation = roomBookings[slot].items[i];
+            int lastNight = stayEndNight(reservation->checkInDay, reservation->checkOutDay);
+            countStayNights(rooms[slot].typeId, reservation->checkInDay, lastNight, -1);
+            countStayNights(typeId, reservation->checkInDay, lastNight, 1);
+        }
+        removeRoomTypeSlot(rooms[slot].typeId, slot);
+        addRoomTypeSlot(typeId, slot);
+        rooms[slot].typeId = typeId;
+    }
+    countRoomStats(roomNumber, 1);
+}
+
+// A room as a snapshot or an import saved it, with the rate its type had then
+void restoreRoom(int roomNumber, char roomType[], double pricePerNight) {
+    if (roomNumber < 1) {
+        return;
+    }
+    setRoom(roomNumber, roomType, pricePerNight);
+    setRoomTypeRate(internRoomType(roomType), pricePerNight);
+}
+
+// Reprice every room of a type, stays already booked included
+void setRoomTypeRate(int typeId, double pricePerNight) {
+    roomTypes[typeId].pricePerNight = pricePerNight;
+}
+
+void openJournal() {
+    journalOpen = 1;
+    journalFile = fopen(journalFilePath, "a");
+    
+    // A new file starts with the segment its records belong to
+    if (journalFile != NULL && fseek(journalFile, 0, SEEK_END) == 0 && ftell(journalFile) == 0 &&
+        (fprintf(journalFile, "SEGMENT:%u\n", journalSegment) < 0 || fflush(journalFile) != 0)) {
+        fclose(journalFile);
+        journalFile = NULL;
+    }
+}
+
+void closeJournal() {
+    journalOpen = 0;
+    if (journalFile != NULL) {
+        flushJournal();
+        fclose(journalFile);
+        journalFile = NULL;
+    }
+    free(journalQueue.data);
+    memset(&journalQueue, 0, sizeof(journalQueue));
+}
+
+// Choose when mutations count as done. With backgroundWriter set another
+// thread calls takeJournalBatch/writeJournalBatch and journalCommit leaves
+// the queue to it.
+void hotelSetPersistence(PersistMode mode, int windowMillis, int backgroundWriter) {
+    persistMode = mode;
+    persistWindowMillis = windowMillis >= 0 ? windowMillis : DEFAULT_PERSIST_WINDOW_MS;
+    journalBackgroundWriter = backgroundWriter;
+}
+
+// Queue one mutation record. Nothing reaches the file until the queue is written.
+// Records are queued even while the file cannot be opened, so that writing
+// them fails instead of losing them silently.
+void journalRecord(const char* format, ...) {
+    if (!journalOpen) {
+        return;
+    }
+    
+    if (journalQueue.capacity - journalQueue.length < JOURNAL_LINE_LEN) {
+        journalQueue.capacity = journalQueue.capacity > 0 ? journalQueue.capacity * 2 : 4096;
+        journalQueue.data = (char*)realloc(journalQueue.data, journalQueue.capacity);
+    }
+    
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(journalQueue.data + journalQueue.length, JOURNAL_LINE_LEN - 1, format, args);
+    va_end(args);
+    if (length < 0 || length > JOURNAL_LINE_LEN - 2) {
+        length = JOURNAL_LINE_LEN - 2;
+    }
+    journalQueue.data[journalQueue.length + length] = '\n';
+    journalQueue.length += length + 1;
+    
+    if (journalQueue.records == 0) {
+        journalQueue.firstQueuedAt = metricsClock();
+    }
+    journalQueue.records++;
+    journalQueue.lastSequence = ++journalSequence;
+    journalRecordsSinceSnapshot++;
+    journalBytesSinceSnapshot += length + 1;
+    metricsAdd(COUNTER_JOURNAL_RECORDS, 1);
+    metricsAdd(COUNTER_JOURNAL_BYTES, length + 1);
+}
+
+// End of a mutation. Strict mode writes the queue now; relaxed mode lets it
+// collect until it holds JOURNAL_SYNC_BATCH records or its oldest record has
+// waited a whole window, so one write and one fsync cover many mutations.
+void journalCommit() {
+    if (journalBackgroundWriter || journalQueue.records == 0) {
+        return;
+    }
+    if (persistMode == PERSIST_STRICT || journalQueue.records >= JOURNAL_SYNC_BATCH ||
+        metricsClock() - journalQueue.firstQueuedAt >= (unsigned long long)persistWindowMillis * 1000000ULL) {
+        flushJournal();
+    }
+}
+
+// Close the journal segment covered by the snapshot being captured and start
+// an empty one under the next journalSegment. The closed segment is kept as
+// oldJournalFilePath until that snapshot is in place; if an earlier snapshot
+// never got there, its segment is still needed and the current one is
+// appended to it. Returns 0 if any step failed; both segments are then left
+// as they were and records keep going to the current one.
+int rotateJournal() {
+    unsigned long long failedBefore = journalFailedSequence;
+    int success;
+    
+    if (journalFile == NULL) {
+        openJournal();
+    }
+    if (journalFile == NULL) {
+        return 0;
+    }
+    // Only a write failing now stops the rotation; records lost earlier are
+    // what the snapshot being captured is for
+    flushJournal();
+    if (journalFailedSequence != failedBefore) {
+        return 0;
+    }
+    fclose(journalFile);
+    journalFile = NULL;
+    
+    FILE* oldSegment = fopen(oldJournalFilePath, "rb");
+    if (oldSegment == NULL) {
+        success = rename(journalFilePath, oldJournalFilePath) == 0;
+    } else {
+        fclose(oldSegment);
+        long oldLength = appendJournalSegment(journalFilePath, oldJournalFilePath);
+        success = oldLength >= 0;
+        if (success && remove(journalFilePath) != 0) {
+            // The records are still in the current segment; take them off the old one
+            truncateJournalSegment(oldJournalFilePath, oldLength);
+            success = 0;
+        }
+    }
+    if (success) {
+        journalSegment++;
+    }
+    openJournal();
+    return success && journalFile != NULL;
+}
+
+// Append the file fromPath to toPath and fsync it. Returns the length toPath
+// had before, or -1 if the copy failed, in which case toPath is cut back to
+// that length.
+long appendJournalSegment(const char fromPath[], const char toPath[]) {
+    char buffer[1 << 16];
+    size_t length;
+    int success = 1;
+    
+    FILE* from = fopen(fromPath, "rb");
+    if (from == NULL) {
+        return -1;
+    }
+    FILE* to = fopen(toPath, "ab");
+    if (to == NULL) {
+        fclose(from);
+        return -1;
+    }
+    long oldLength = fseek(to, 0, SEEK_END) == 0 ? ftell(to) : -1;
+    success = oldLength >= 0;
+    while (success && (length = fread(buffer, 1, sizeof(buffer), from)) > 0) {
+        success = fwrite(buffer, 1, length, to) == length;
+    }
+    success = success && !ferror(from) && fflush(to) == 0 && fsync(fileno(to)) == 0;
+    if (!success && oldLength >= 0) {
+        fflush(to);
+        ftruncate(fileno(to), oldLength);
+    }
+    fclose(to);
+    fclose(from);
+    return success ? oldLength : -1;
+}
+
+// Cut a journal segment back to length bytes, dropping a failed append
+int truncateJournalSegment(const char path[], long length) {
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        return 0;
+    }
+    int success = ftruncate(fileno(file), length) == 0 && fsync(fileno(file)) == 0;
+    fclose(file);
+    return success;
+}
+
+// Write and fsync everything queued. Returns 0 if the write failed, and
+// from then on until a snapshot covers the records that were lost; the
+// durable sequence stays where it was meanwhile.
+int flushJournal() {
+    unsigned long long sequence = journalSequence;
+    if (!writeJournalBatch(&journalQueue)) {
+        journalFailedSequence = sequence;
+    }
+    if (journalFailedSequence > journalDurableSequence) {
+        return 0;
+    }
+    journalDurableSequence = sequence;
+    return 1;
+}
+
+// Swap the queue with batch, whose buffer is reused for the next records.
+// Called under the engine lock; the batch can then be written without it.
+void takeJournalBatch(JournalBatch* batch) {
+    JournalBatch taken = journalQueue;
+    
+    journalQueue = *batch;
+    journalQueue.length = 0;
+    journalQueue.records = 0;
+    *batch = taken;
+    batch->lastSequence = journalSequence;
+}
+
+// One write and one fsync for a whole batch; touches no engine state but
+// the journal file
+int writeJournalBatch(JournalBatch* batch) {
+    int success = 1;
+    
+    // A journal that could not be reopened is tried again with every batch;
+    // until it opens, no batch counts as written
+    if (batch->length > 0 && journalFile == NULL) {
+        openJournal();
+        success = journalFile != NULL;
+    }
+    if (batch->length > 0 && journalFile != NULL) {
+        unsigned long long start = metricsClock();
+        success = fwrite(batch->data, 1, batch->length, journalFile) == batch->length && fflush(journalFile) == 0 &&
+                  fsync(fileno(journalFile)) == 0;
+        metricsRecord(METRIC_JOURNAL_SYNC, start);
+    }
+    batch->length = 0;
+    batch->records = 0;
+    return success;
+}
+
+// Re-apply journal records on top of the snapshot. Records that are already
+// reflected in the snapshot (a crash between snapshot and truncation) are skipped.
+void replayJournal() {
+    unsigned int coveredSegment = journalSegment;
+    
+    // Segments left by a checkpoint that did not finish come first
+    replayJournalFile(oldJournalFilePath, coveredSegment);
+    replayJournalFile(journalFilePath, coveredSegment);
+}
+
+// Apply the records of one journal file, skipping segments that the loaded
+// snapshot already includes (a checkpoint may crash after its rename but
+// before it removes the old segment). A record or group cut off by a crash
+// at the end of the file was never acknowledged; it is cut from the file so
+// that records written after the restart do not land inside it.
+void replayJournalFile(const char path[], unsigned int coveredSegment) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return;
+    }
+    
+    char line[JOURNAL_LINE_LEN];
+    unsigned int segment = 0;
+    int groupSize;
+    long cutOffAt = -1;
+    for (;;) {
+        long lineStart = ftell(file);
+        if (fgets(line, sizeof(line), file) == NULL) {
+            break;
+        }
+        if (strchr(line, '\n') == NULL && feof(file)) {
+            cutOffAt = lineStart;
+            break;
+        }
+        if (sscanf(line, "SEGMENT:%u", &segment) == 1) {
+            if (segment > journalSegment) {
+                journalSegment = segment;
+            }
+            continue;
+        }
+        if (segment < coveredSegment) {
+            continue;
+        }
+        
+        // Replayed records are owed to the next checkpoint
+        journalRecordsSinceSnapshot++;
+        journalBytesSinceSnapshot += strlen(line);
+        
+        // A group only counts if its END_GROUP made it to disk
+        if (sscanf(line, "BEGIN_GROUP:%d", &groupSize) == 1) {
+            if (replayJournalGroup(file, groupSize) < 0) {
+                cutOffAt = lineStart;
+                break;
+            }
+        } else {
+            replayJournalRecord(line);
+        }
+    }
+    
+    fclose(file);
+    if (cutOffAt >= 0) {
+        truncateJournalSegment(path, cutOffAt);
+    }
+}
+
+// Read the records of a group booking and apply them only if the group is
+// complete. Returns 1 if it was applied, 0 if it was damaged and skipped up
+// to its END_GROUP (or up to the next group or segment, which is left for
+// the caller) and -1 if the file ends inside it.
+int replayJournalGroup(FILE* file, int groupSize) {
+    char (*records)[JOURNAL_LINE_LEN] = NULL;
+    char extra[JOURNAL_LINE_LEN];
+    int read = 0;
+    int result = 0;
+    int i;
+    
+    if (groupSize > 0) {
+        records = (char (*)[JOURNAL_LINE_LEN])malloc(groupSize * sizeof(*records));
+    }
+    
+    for (;;) {
+        long lineStart = ftell(file);
+        char* line = records != NULL && read < groupSize ? records[read] : extra;
+        if (fgets(line, JOURNAL_LINE_LEN, file) == NULL || (strchr(line, '\n') == NULL && feof(file))) {
+            // Past its size the group was damaged before the crash, not cut off by it
+            result = read <= groupSize ? -1 : 0;
+            break;
+        }
+        if (strncmp(line, "END_GROUP", 9) == 0) {
+            result = records != NULL && read == groupSize;
+            break;
+        }
+        if (strncmp(line, "BEGIN_GROUP:", 12) == 0 || strncmp(line, "SEGMENT:", 8) == 0) {
+            fseek(file, lineStart, SEEK_SET);
+            break;
+        }
+        read++;
+    }
+    if (result == 1) {
+        for (i = 0; i < groupSize; i++) {
+            replayJournalRecord(records[i]);
+        }
+    }
+    
+    free(records);
+    return result;
+}
+
+void replayJournalRecord(char line[]) {
+    char username[MAX_NAME_LEN], password[MAX_PASSWORD_LEN], roomType[MAX_ROOM_TYPE_LEN];
+    int roomNumber, lastRoom, isAdmin, newRoom;
+    int checkInDay, checkInMinute, checkOutDay, checkOutMinute, oldDay, oldMinute;
+    int locked = 1; // Records from before the flag was journaled
+    double pricePerNight;
+    
+    if (sscanf(line, "ADD_RESERVATION:%49[^:]:%d:%d:%d:%d:%d:%d", username, &roomNumber,
+               &checkInDay, &checkInMinute, &checkOutDay, &checkOutMinute, &locked) >= 6) {
+        if (findReservation(roomNumber, checkInDay, checkInMinute) == NULL) {
+            addReservation(username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute)->locked = locked;
+        }
+    } else if (sscanf(line, "MOVE_RESERVATION:%49[^:]:%d:%d:%d:%d:%d:%d", username, &roomNumber, &checkInDay,
+                      &checkInMinute, &checkOutDay, &checkOutMinute, &newRoom) == 7) {
+        Reservation* reservation = findExactReservation(username, roomNumber, checkInDay, checkInMinute,
+                                                        checkOutDay, checkOutMinute);
+        if (reservation != NULL && findRoomSlot(newRoom) >= 0) {
+            moveReservation(reservation, newRoom);
+        }
+    } else if (sscanf(line, "REMOVE_RESERVATION:%d:%d:%d", &roomNumber, &checkInDay, &checkInMinute) == 3) {
+        Reservation* reservation = findReservation(roomNumber, checkInDay, checkInMinute);
+        if (reservation != NULL) {
+            deleteReservation(reservation);
+        }
+    } else if (sscanf(line, "MODIFY_RESERVATION:%d:%d:%d:%d:%d:%d:%d", &roomNumber, &oldDay, &oldMinute,
+                      &checkInDay, &checkInMinute, &checkOutDay, &checkOutMinute) == 7) {
+        Reservation* reservation = findReservation(roomNumber, oldDay, oldMinute);
+        if (reservation != NULL) {
+            updateReservationDates(reservation, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        }
+    } else if (sscanf(line, "ADD_USER:%49[^:]:%49[^:]:%d", username, password, &isAdmin) == 3) {
+        addUser(username, password, isAdmin);
+    } else if (sscanf(line, "DELETE_USER:%49[^\n]", username) == 1) {
+        User* user = findUser(username);
+        if (user != NULL) {
+            removeUser(user);
+        }
+    } else if (sscanf(line, "CHANGE_PASSWORD:%49[^:]:%49[^\n]", username, password) == 2) {
+        User* user = findUser(username);
+        if (user != NULL) {
+            strcpy(user->password, password);
+        }
+    } else if (sscanf(line, "CREATE_ROOM:%d:%49[^:]:%lf", &roomNumber, roomType, &pricePerNight) == 3) {
+        setRoom(roomNumber, roomType, pricePerNight);
+    } else if (sscanf(line, "CREATE_ROOMS:%d:%d:%49[^:]:%lf", &roomNumber, &lastRoom, roomType, &pricePerNight) == 4) {
+        for (; roomNumber <= lastRoom; roomNumber++) {
+            setRoom(roomNumber, roomType, pricePerNight);
+        }
+    } else if (sscanf(line, "SET_RATE:%49[^:]:%lf", roomType, &pricePerNight) == 2) {
+        int typeId = findRoomType(roomType);
+        if (typeId >= 0) {
+            setRoomTypeRate(typeId, pricePerNight);
+        }
+    }
+}
+
+// Returns 0 if expired reservations could not be archived
+int checkExpiredReservations() {
+    unsigned long long start = metricsClock();
+    int today, minute;
+    getCurrentDateTime(&today, &minute);
+    
+    int success = expireReservations(today, minute);
+    advanceOccupancyHorizon(today);
+    metricsRecord(METRIC_EXPIRY, start);
+    return success;
+}
+
+void getCurrentDateTime(int* day, int* minute) {
+    time_t now = time(NULL);
+    struct tm* currentTime = localtime(&now);
+    
+    *day = daysFromCivil(currentTime->tm_year + 1900, currentTime->tm_mon + 1, currentTime->tm_mday);
+    *minute = currentTime->tm_hour * 60 + currentTime->tm_min;
+}
+
+// Pop reservations off the expiry heap until the earliest check-out is in the future
+// Expired reservations go to the archive before they leave memory. Returns 0
+// if the archive could not take them: expiry then stops at the first
+// reservation that could not be packed, and the next sweep retries a failed
+// commit before it expires anything else.
+int expireReservations(int today, int minute) {
+    int throughDay = today;
+    int throughMinute = minute;
+    int success = 1;
+    
+    if (archiveCommitPending && !commitArchive(archivedThroughDay, archivedThroughMinute)) {
+        return 0;
+    }
+    while (expiryHeapSize > 0) {
+        Reservation* earliest = expiryHeap[0];
+        if (compareDateTime(earliest->checkOutDay, earliest->checkOutMinute, today, minute) >= 0) {
+            break;
+        }
+        if (!archiveReservation(earliest)) {
+            // It stays live, so the watermark must not pass it
+            throughDay = earliest->checkOutDay;
+            throughMinute = earliest->checkOutMinute;
+            success = 0;
+            break;
+        }
+        // This reservation has expired
+        int slot = findRoomSlot(earliest->roomNumber);
+        if (slot >= 0) {
+            closeStayNights(rooms[slot].typeId, earliest->checkInDay, earliest->checkOutDay,
+                            roomTypes[rooms[slot].typeId].pricePerNight);
+        }
+        deleteReservation(earliest);
+        metricsAdd(COUNTER_EXPIRED, 1);
+    }
+    if (archiveCommitPending && !commitArchive(throughDay, throughMinute)) {
+        success = 0;
+    }
+    return success;
+}
+
+// Expiry is not journaled, so a restart can bring back reservations that an
+// earlier sweep already archived; drop those without archiving them again
+void dropArchivedReservations() {
+    while (expiryHeapSize > 0) {
+        Reservation* earliest = expiryHeap[0];
+        if (compareDateTime(earliest->checkOutDay, earliest->checkOutMinute, archivedThroughDay, archivedThroughMinute) >= 0) {
+            break;
+        }
+        deleteReservation(earliest);
+    }
+}
+
+int expiresBefore(Reservation* a, Reservation* b) {
+    return compareDateTime(a->checkOutDay, a->checkOutMinute, b->checkOutDay, b->checkOutMinute) < 0;
+}
+
+void swapHeapEntries(int i, int j) {
+    Reservation* temp = expiryHeap[i];
+    expiryHeap[i] = expiryHeap[j];
+    expiryHeap[j] = temp;
+    expiryHeap[i]->heapIndex = i;
+    expiryHeap[j]->heapIndex = j;
+}
+
+void siftExpiryUp(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!expiresBefore(expiryHeap[index], expiryHeap[parent])) {
+            break;
+        }
+        swapHeapEntries(index, parent);
+        index = parent;
+    }
+}
+
+void siftExpiryDown(int index) {
+    while (1) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        
+        if (left < expiryHeapSize && expiresBefore(expiryHeap[left], expiryHeap[smallest])) {
+            smallest = left;
+        }
+        if (right < expiryHeapSize && expiresBefore(expiryHeap[right], expiryHeap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        swapHeapEntries(index, smallest);
+        index = smallest;
+    }
+}
+
+void scheduleExpiry(Reservation* reservation) {
+    if (expiryHeapSize >= expiryHeapCapacity) {
+        expiryHeapCapacity = expiryHeapCapacity > 0 ? expiryHeapCapacity * 2 : 64;
+        expiryHeap = (Reservation**)realloc(expiryHeap, expiryHeapCapacity * sizeof(Reservation*));
+    }
+    
+    reservation->heapIndex = expiryHeapSize;
+    expiryHeap[expiryHeapSize++] = reservation;
+    siftExpiryUp(reservation->heapIndex);
+}
+
+void unscheduleExpiry(Reservation* reservation) {
+    int index = reservation->heapIndex;
+    expiryHeapSize--;
+    if (index != expiryHeapSize) {
+        // Fill the hole with the last entry and restore the heap around it
+        Reservation* moved = expiryHeap[expiryHeapSize];
+        swapHeapEntries(index, expiryHeapSize);
+        siftExpiryUp(index);
+        siftExpiryDown(moved->heapIndex);
+    }
+}
+
+int compareDateTime(int day1, int minute1, int day2, int minute2) {
+    if (day1 != day2) {
+        return day1 < day2 ? -1 : 1;
+    }
+    if (minute1 != minute2) {
+        return minute1 < minute2 ? -1 : 1;
+    }
+    return 0;
+}
+
+// Convert a validated YYYY-MM-DD date into days since 1970-01-01
+int dateToDay(char date[]) {
+    int year = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+    int month = (date[5] - '0') * 10 + (date[6] - '0');
+    int day = (date[8] - '0') * 10 + (date[9] - '0');
+    
+    return daysFromCivil(year, month, day);
+}
+
+int daysFromCivil(int year, int month, int day) {
+    // Count years from March so the leap day falls at the end of the year
+    if (month <= 2) {
+        year--;
+    }
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Convert a validated HH:MM time into minutes since midnight
+int timeToMinute(char time[]) {
+    return ((time[0] - '0') * 10 + (time[1] - '0')) * 60 + (time[3] - '0') * 10 + (time[4] - '0');
+}
+
+void dayToDate(int day, char date[]) {
+    int year, month, dayOfMonth;
+    
+    civilFromDays(day, &year, &month, &dayOfMonth);
+    sprintf(date, "%04d-%02d-%02d", year, month, dayOfMonth);
+}
+
+// Inverse of daysFromCivil
+void civilFromDays(int day, int* year, int* month, int* dayOfMonth) {
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int dayOfEra = day - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    *dayOfMonth = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    *month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+// Parse YYYY-MM-DD and, unless time is NULL, HH:MM. Returns 0 if either is invalid.
+int parseDateTime(char date[], char time[], int* day, int* minute) {
+    if (!isValidDate(date) || (time != NULL && !isValidTime(time))) {
+        return 0;
+    }
+    
+    *day = dateToDay(date);
+    if (minute != NULL) {
+        *minute = timeToMinute(time);
+    }
+    return 1;
+}
+
+void minuteToTime(int minute, char time[]) {
+    unsigned int minuteOfDay = (unsigned int)minute % 1440;
+    sprintf(time, "%02u:%02u", minuteOfDay / 60, minuteOfDay % 60);
+}
+
+char* formatDateTime(int day, int minute) {
+    // Rotate buffers so check-in and check-out can be formatted in one printf
+    static char formatted[4][30];
+    static int next = 0;
+    char* buffer = formatted[next];
+    next = (next + 1) % 4;
+    
+    dayToDate(day, buffer);
+    buffer[10] = ' ';
+    minuteToTime(minute, buffer + 11);
+    return buffer;
+}
+
+// First reservation of a user in the given room
+Reservation* findUserReservation(char username[], int roomNumber) {
+    Reservation* current = getUserReservations(username);
+    while (current != NULL) {
+        if (current->roomNumber == roomNumber) {
+            return current;
+        }
+        current = current->userNext;
+    }
+    return NULL;
+}
+
+// Head of a user's reservation chain; follow userNext for the rest
+Reservation* getUserReservations(char username[]) {
+    User* user = findUser(username);
+    return user != NULL ? user->reservations : NULL;
+}
+
+void linkUserReservation(User* user, Reservation* reservation) {
+    reservation->userPrev = NULL;
+    reservation->userNext = user->reservations;
+    if (user->reservations != NULL) {
+        user->reservations->userPrev = reservation;
+    }
+    user->reservations = reservation;
+    reservationColumns.userIds[reservation->columnRow] = user->id;
+}
+
+void unlinkUserReservation(User* user, Reservation* reservation) {
+    if (reservation->userPrev == NULL) {
+        user->reservations = reservation->userNext;
+    } else {
+        reservation->userPrev->userNext = reservation->userNext;
+    }
+    if (reservation->userNext != NULL) {
+        reservation->userNext->userPrev = reservation->userPrev;
+    }
+}
+
+// Reservations can be booked for a name before it is registered (journal
+// replay, batch files). Only then does a new user need a pass over the list.
+void adoptOrphanReservations(User* user) {
+    Reservation* current = reservationList;
+    Reservation* last = NULL;
+    
+    // Walk from the oldest end so the chain keeps newest-first order
+    while (current != NULL) {
+        last = current;
+        current = current->next;
+    }
+    for (current = last; current != NULL && orphanReservations > 0; current = current->prev) {
+        if (strcmp(current->username, user->username) == 0) {
+            linkUserReservation(user, current);
+            orphanReservations--;
+        }
+    }
+}
+
+// Use <prefix>.bin, <prefix>.jnl, <prefix>.dat and the <prefix> archive instead of the default files
+void hotelSetDataFiles(const char prefix[]) {
+    snprintf(snapshotFilePath, sizeof(snapshotFilePath), "%s.bin", prefix);
+    snprintf(journalFilePath, sizeof(journalFilePath), "%s.jnl", prefix);
+    snprintf(oldJournalFilePath, sizeof(oldJournalFilePath), "%s.jnl.old", prefix);
+    snprintf(textFilePath, sizeof(textFilePath), "%s.dat", prefix);
+    snprintf(archivePrefix, sizeof(archivePrefix), "%s", prefix);
+}
+
+// Parse text snapshots on this many threads; 0 picks one per processor
+void hotelSetLoaderThreads(int threads) {
+    loaderThreads = threads;
+}
+
+// Load the data files and get ready to accept mutations
+HotelStatus hotelInit() {
+    initializeRooms();
+    loadData();
+    openArchive();
+    dropArchivedReservations();
+    loadClosedNights();
+    checkExpiredReservations();
+    openJournal();
+    
+    // Add default users if they don't exist
+    if (userList == NULL) {
+        addUser("admin", "admin123", 1);
+        addUser("user1", "password1", 0);
+    }
+    return journalFile != NULL ? HOTEL_OK : HOTEL_ERR_IO;
+}
+
+void hotelShutdown() {
+    closeJournal();
+    closeArchive();
+    cleanup();
+}
+
+HotelStatus hotelBook(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    unsigned long long start = metricsClock();
+    HotelStatus status = hotelCheckBooking(roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+    if (status == HOTEL_OK) {
+        hotelCommitBooking(username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        journalCommit();
+    }
+    metricsRecord(METRIC_BOOK, start);
+    return status;
+}
+
+// Validate a booking. Only reads the room's own index, so callers holding
+// just that room's lock may run it concurrently with other rooms.
+HotelStatus hotelCheckBooking(int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    if (findRoomSlot(roomNumber) < 0) {
+        return HOTEL_ERR_INVALID_ROOM;
+    }
+    if (compareDateTime(checkInDay, checkInMinute, checkOutDay, checkOutMinute) >= 0) {
+        return HOTEL_ERR_INVALID_DATES;
+    }
+    if (!isRoomAvailableForDates(roomNumber, checkInDay, checkOutDay)) {
+        return HOTEL_ERR_ROOM_UNAVAILABLE;
+    }
+    return HOTEL_OK;
+}
+
+// Book several rooms for one guest, all or nothing. Entries with roomNumber 0
+// get any free room of their roomType ("all" for any type); on success their
+// roomNumber holds the room assigned. On failure nothing is booked and
+// failedIndex (if not NULL) names the first entry that could not be placed,
+// or is -1 if the failure was not about any one entry.
+HotelStatus hotelBookGroup(char username[], GroupBooking bookings[], int count, int* failedIndex) {
+    unsigned long long start = metricsClock();
+    int* assigned;
+    int* candidates;
+    HotelStatus status = HOTEL_OK;
+    int i, j;
+    
+    if (failedIndex != NULL) {
+        *failedIndex = -1;
+    }
+    if (count < 1) {
+        return HOTEL_OK;
+    }
+    assigned = (int*)malloc(count * sizeof(int));
+    candidates = (int*)malloc((count + 1) * sizeof(int));
+    if (assigned == NULL || candidates == NULL) {
+        free(assigned);
+        free(candidates);
+        return HOTEL_ERR_IO;
+    }
+    
+    // Check every entry against the room indexes and the entries placed before it
+    for (i = 0; i < count && status == HOTEL_OK; i++) {
+        GroupBooking* booking = &bookings[i];
+        
+        if (booking->roomNumber != 0) {
+            status = hotelCheckBooking(booking->roomNumber, booking->checkInDay, booking->checkInMinute,
+                                       booking->checkOutDay, booking->checkOutMinute);
+            if (status == HOTEL_OK && groupConflict(bookings, assigned, i, booking->roomNumber)) {
+                status = HOTEL_ERR_ROOM_UNAVAILABLE;
+            }
+            assigned[i] = booking->roomNumber;
+        } else if (compareDateTime(booking->checkInDay, booking->checkInMinute,
+                                   booking->checkOutDay, booking->checkOutMinute) >= 0) {
+            status = HOTEL_ERR_INVALID_DATES;
+        } else {
+            // Earlier entries can block at most i of the free rooms, so i + 1 candidates are enough
+            int found = searchRooms(booking->roomType, booking->checkInDay, booking->checkOutDay, candidates, i + 1);
+            assigned[i] = 0;
+            for (j = 0; j < found && assigned[i] == 0; j++) {
+                if (!groupConflict(bookings, assigned, i, candidates[j])) {
+                    assigned[i] = candidates[j];
+                }
+            }
+            if (assigned[i] == 0) {
+                status = HOTEL_ERR_ROOM_UNAVAILABLE;
+            }
+        }
+    }
+    
+    if (status != HOTEL_OK) {
+        if (failedIndex != NULL) {
+            *failedIndex = i - 1;
+        }
+    } else {
+        // Bracket the group so journal replay applies all of it or none
+        journalRecord("BEGIN_GROUP:%d", count);
+        for (i = 0; i < count; i++) {
+            // Rooms picked from a type may be moved later; named rooms stay put
+            commitBooking(username, assigned[i], bookings[i].checkInDay, bookings[i].checkInMinute,
+                          bookings[i].checkOutDay, bookings[i].checkOutMinute, bookings[i].roomNumber != 0);
+            bookings[i].roomNumber = assigned[i];
+        }
+        journalRecord("END_GROUP");
+        journalCommit();
+    }
+    
+    free(assigned);
+    free(candidates);
+    metricsRecord(METRIC_GROUP_BOOK, start);
+    return status;
+}
+
+// Whether roomNumber clashes with one of the first count entries of a group
+int groupConflict(GroupBooking bookings[], int assigned[], int count, int roomNumber) {
+    GroupBooking* booking = &bookings[count];
+    int i;
+    
+    for (i = 0; i < count; i++) {
+        if (assigned[i] == roomNumber &&
+            !(booking->checkOutDay < bookings[i].checkInDay || booking->checkInDay > bookings[i].checkOutDay)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Store a booking that passed hotelCheckBooking, locked to the room the guest chose
+void hotelCommitBooking(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    commitBooking(username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute, 1);
+}
+
+// Store a checked booking; unlocked ones are rooms the engine picked
+void commitBooking(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, int locked) {
+    addReservation(username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute)->locked = locked;
+    
+    // Append the booking to the journal instead of rewriting the data file
+    journalRecord("ADD_RESERVATION:%s:%d:%d:%d:%d:%d:%d", username, roomNumber,
+                  checkInDay, checkInMinute, checkOutDay, checkOutMinute, locked);
+}
+
+HotelStatus hotelCancel(char username[], int roomNumber) {
+    unsigned long long start = metricsClock();
+    HotelStatus status = HOTEL_ERR_NOT_FOUND;
+    
+    Reservation* reservation = findUserReservation(username, roomNumber);
+    if (reservation != NULL) {
+        journalRecord("REMOVE_RESERVATION:%d:%d:%d", reservation->roomNumber,
+                      reservation->checkInDay, reservation->checkInMinute);
+        deleteReservation(reservation);
+        journalCommit();
+        status = HOTEL_OK;
+    }
+    
+    metricsRecord(METRIC_CANCEL, start);
+    return status;
+}
+
+HotelStatus hotelModify(Reservation* reservation, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute) {
+    unsigned long long start = metricsClock();
+    HotelStatus status = HOTEL_OK;
+    
+    if (compareDateTime(checkInDay, checkInMinute, checkOutDay, checkOutMinute) >= 0) {
+        status = HOTEL_ERR_INVALID_DATES;
+    } else if (!isRoomAvailableExcluding(reservation->roomNumber, checkInDay, checkOutDay, reservation)) {
+        status = HOTEL_ERR_ROOM_UNAVAILABLE;
+    } else {
+        journalRecord("MODIFY_RESERVATION:%d:%d:%d:%d:%d:%d:%d", reservation->roomNumber,
+                      reservation->checkInDay, reservation->checkInMinute,
+                      checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        updateReservationDates(reservation, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        journalCommit();
+    }
+    
+    metricsRecord(METRIC_MODIFY, start);
+    return status;
+}
+
+HotelStatus hotelRegister(char username[], char password[], int isAdmin) {
+    if (findUser(username) != NULL) {
+        return HOTEL_ERR_USER_EXISTS;
+    }
+    
+    addUser(username, password, isAdmin);
+    journalRecord("ADD_USER:%s:%s:%d", username, password, isAdmin);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+HotelStatus hotelDeleteUser(char username[]) {
+    // Don't allow deleting the admin account
+    if (strcmp(username, "admin") == 0) {
+        return HOTEL_ERR_PROTECTED_USER;
+    }
+    
+    User* user = findUser(username);
+    if (user == NULL) {
+        return HOTEL_ERR_NOT_FOUND;
+    }
+    
+    removeUser(user);
+    journalRecord("DELETE_USER:%s", username);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+HotelStatus hotelChangePassword(char username[], char newPassword[]) {
+    User* user = findUser(username);
+    if (user == NULL) {
+        return HOTEL_ERR_NOT_FOUND;
+    }
+    
+    strcpy(user->password, newPassword);
+    journalRecord("CHANGE_PASSWORD:%s:%s", username, newPassword);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+// pricePerNight is the rate of roomType if the type is new; rooms added to a
+// known type do not change its rate (hotelSetRoomRate does)
+HotelStatus hotelCreateRoom(int roomNumber, char roomType[], double pricePerNight) {
+    if (roomNumber < 1) {
+        return HOTEL_ERR_INVALID_ROOM;
+    }
+    
+    setRoom(roomNumber, roomType, pricePerNight);
+    journalRecord("CREATE_ROOM:%d:%s:%.2f", roomNumber, roomType, pricePerNight);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+// Create or update every room from firstRoom to lastRoom, e.g. a whole
+// floor 1201..1230, as one journal record
+HotelStatus hotelCreateRoomRange(int firstRoom, int lastRoom, char roomType[], double pricePerNight) {
+    int roomNumber;
+    
+    if (firstRoom < 1 || lastRoom < firstRoom || lastRoom - firstRoom >= MAX_ROOM_RANGE) {
+        return HOTEL_ERR_INVALID_ROOM;
+    }
+    
+    growRoomTable(totalRooms + (lastRoom - firstRoom + 1));
+    for (roomNumber = firstRoom; roomNumber <= lastRoom; roomNumber++) {
+        setRoom(roomNumber, roomType, pricePerNight);
+    }
+    journalRecord("CREATE_ROOMS:%d:%d:%s:%.2f", firstRoom, lastRoom, roomType, pricePerNight);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+// Change the nightly rate of every room of a type
+HotelStatus hotelSetRoomRate(char roomType[], double pricePerNight) {
+    int typeId = findRoomType(roomType);
+    if (typeId < 0) {
+        return HOTEL_ERR_NOT_FOUND;
+    }
+    
+    setRoomTypeRate(typeId, pricePerNight);
+    journalRecord("SET_RATE:%s:%.2f", roomType, pricePerNight);
+    journalCommit();
+    return HOTEL_OK;
+}
+
+HotelStatus hotelSave() {
+    return saveData() ? HOTEL_OK : HOTEL_ERR_IO;
+}
+
+// Convert between the binary snapshot and the USER:/RESERVATION:/ROOM: text format
+HotelStatus hotelConvert(int toText, const char inputPath[], const char outputPath[]) {
+    int success;
+    
+    initializeRooms();
+    if (toText) {
+        success = loadBinarySnapshot(inputPath) && saveTextSnapshot(outputPath);
+    } else {
+        success = loadTextSnapshot(inputPath) && saveBinarySnapshot(outputPath);
+    }
+    cleanup();
+    
+    return success ? HOTEL_OK : HOTEL_ERR_IO;
+}
+
+const char* hotelStatusMessage(HotelStatus status) {
+    switch (status) {
+        case HOTEL_OK:
+            return "OK";
+        case HOTEL_ERR_INVALID_ROOM:
+            return "Invalid room number";
+        case HOTEL_ERR_INVALID_DATES:
+            return "Check-in date/time must be before check-out date/time";
+        case HOTEL_ERR_ROOM_UNAVAILABLE:
+            return "Room is not available for the selected dates";
+        case HOTEL_ERR_NOT_FOUND:
+            return "Not found";
+        case HOTEL_ERR_USER_EXISTS:
+            return "Username already exists";
+        case HOTEL_ERR_PROTECTED_USER:
+            return "Cannot delete the main admin account";
+        case HOTEL_ERR_IO:
+            return "Could not access the data files";
+    }
+    return "Unknown error";
+}
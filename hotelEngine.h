@@ -0,0 +1,431 @@
+#ifndef HOTEL_ENGINE_H
+#define HOTEL_ENGINE_H
+
+// Booking engine shared by the console application, the batch runner and
+// the benchmark. Nothing in here reads the keyboard or draws on screen.
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define MAX_NAME_LEN 50
+#define MAX_PASSWORD_LEN 50
+#define MAX_ROOM_TYPE_LEN 50
+#define MAX_DESCRIPTION_LEN 64
+#define MAX_PATH_LEN 260
+#define DATA_FILE "reservations.dat"
+#define JOURNAL_FILE "reservations.jnl"
+#define SNAPSHOT_FILE "reservations.bin"
+#define SNAPSHOT_MAGIC 0x4C544F48u // "HOTL" in a little-endian file
+#define SNAPSHOT_VERSION 2 // Version 1 records have no locked flag
+#define OCCUPANCY_WORDS 16 // Occupancy bitmaps cover 16 * 64 = 1024 days
+#define OCCUPANCY_DAYS (OCCUPANCY_WORDS * 64)
+#define JOURNAL_SYNC_BATCH 16 // Most records a relaxed journal queues before writing
+#define DEFAULT_PERSIST_WINDOW_MS 2 // Window over which journal records are coalesced
+#define JOURNAL_LINE_LEN 256
+#define MAX_ROOM_RANGE 10000 // Most rooms one hotelCreateRoomRange call may create
+#define SNAPSHOT_EVERY_RECORDS 50000 // Journal records that make a checkpoint due
+#define SNAPSHOT_EVERY_BYTES (8 << 20) // Journal bytes that make a checkpoint due
+#define LOADER_MAX_THREADS 16 // Most threads that parse one text snapshot
+#define LOADER_CHUNK_BYTES (1 << 20) // Smallest share of a text snapshot worth its own thread
+#define MINUTES_PER_DAY 1440
+#define SCAN_BLOCK 256 // Rows a column scan tests at a time; the columns grow in whole blocks
+#define SCAN_FIRST_DAY (-1000000) // Filter bounds that take in every stay
+#define SCAN_LAST_DAY 1000000
+
+// Result of the engine API calls
+typedef enum HotelStatus {
+    HOTEL_OK = 0,
+    HOTEL_ERR_INVALID_ROOM,
+    HOTEL_ERR_INVALID_DATES,
+    HOTEL_ERR_ROOM_UNAVAILABLE,
+    HOTEL_ERR_NOT_FOUND,
+    HOTEL_ERR_USER_EXISTS,
+    HOTEL_ERR_PROTECTED_USER,
+    HOTEL_ERR_IO
+} HotelStatus;
+
+typedef struct Room {
+    int roomNumber;
+    int typeId;  // Index into roomTypes
+} Room;
+
+// One entry of the room-type catalog. Rooms refer to it by id, so the name
+// and the nightly rate are stored once per type.
+typedef struct RoomType {
+    char name[MAX_ROOM_TYPE_LEN];
+    char description[MAX_DESCRIPTION_LEN];
+    double pricePerNight;
+    int* roomSlots;  // Slots in rooms of the rooms of this type, ascending
+    int roomCount;
+    int slotCapacity;
+} RoomType;
+
+typedef struct Reservation {
+    char username[MAX_NAME_LEN];
+    int roomNumber;
+    int checkInDay;       // Days since 1970-01-01
+    int checkOutDay;
+    short checkInMinute;  // Minutes since midnight
+    short checkOutMinute;
+    int heapIndex;        // Position in expiryHeap
+    int columnRow;        // Row in reservationColumns
+    int locked;           // The guest chose the room; re-optimization leaves it there
+    struct Reservation* next;
+    struct Reservation* prev;
+    struct Reservation* userNext;  // Chain of the owner's reservations
+    struct Reservation* userPrev;
+} Reservation;
+
+// Live reservations one row each, stored column by column so scans on room
+// and dates read only those. A deleted reservation leaves a tombstone row
+// (room 0, dates that match no range) until the table is compacted.
+typedef struct ReservationColumns {
+    int* roomNumbers;
+    int* checkInStamps;     // day * MINUTES_PER_DAY + minute
+    int* checkOutStamps;
+    int* userIds;           // Owner's User.id, 0 while the name is not registered
+    struct Reservation** items;
+    int count;              // Rows in use, tombstones included
+    int tombstones;
+    int capacity;
+} ReservationColumns;
+
+// What a column scan matches: stays overlapping [fromDay, toDay), in one
+// room and for one user if those are set
+typedef struct ReservationFilter {
+    int roomNumber;  // 0 for every room
+    int userId;      // 0 for every user
+    int fromDay;
+    int toDay;
+} ReservationFilter;
+
+// When a mutation counts as done
+typedef enum PersistMode {
+    PERSIST_STRICT = 0,  // Once its journal record is on disk
+    PERSIST_RELAXED      // Once its record is queued; written within the window
+} PersistMode;
+
+// Journal records waiting to be written, oldest first. Records are numbered
+// from 1 in the order they are queued.
+typedef struct JournalBatch {
+    char* data;
+    size_t length;
+    size_t capacity;
+    int records;
+    unsigned long long lastSequence;   // Newest record queued when the batch was taken
+    unsigned long long firstQueuedAt;  // metricsClock() when the oldest record was queued
+} JournalBatch;
+
+// A checkpoint encoded in memory, exactly as it goes to disk. Built while
+// the engine is held still and written out after it is released.
+typedef struct SnapshotImage {
+    unsigned char* records;  // Header, rooms, users and reservations
+    size_t recordsSize;
+    char* strings;
+    size_t stringsSize;
+    unsigned long long sequence;  // Last journal record the image includes
+} SnapshotImage;
+
+// Free days at the start and end of a stretch of the occupancy bitmap, and
+// the longest run of free days anywhere in it
+typedef struct FreeRun {
+    short prefix;
+    short suffix;
+    short longest;
+} FreeRun;
+
+// Per-room index of reservations, kept sorted by check-in date, plus a
+// bitmap with one bit per day from occupancyBaseDay that is set while the
+// room is booked on that day. freeRuns is a segment tree over the bitmap:
+// node 1 covers the whole horizon, node n has children 2n and 2n+1, and the
+// leaves OCCUPANCY_WORDS..2*OCCUPANCY_WORDS-1 summarize its words.
+typedef struct RoomBookings {
+    Reservation** items;
+    int count;
+    int capacity;
+    unsigned long long occupancy[OCCUPANCY_WORDS];
+    FreeRun freeRuns[2 * OCCUPANCY_WORDS];
+} RoomBookings;
+
+// One room of a group booking: a specific room, or roomNumber 0 to take
+// any free room of roomType
+typedef struct GroupBooking {
+    int roomNumber;
+    char roomType[MAX_ROOM_TYPE_LEN];
+    int checkInDay;
+    int checkInMinute;
+    int checkOutDay;
+    int checkOutMinute;
+} GroupBooking;
+
+// Running totals for one room type, kept current by every mutation
+typedef struct RoomTypeStats {
+    int rooms;
+    int bookedRooms;
+    int reservations;
+} RoomTypeStats;
+
+typedef struct HotelStats {
+    int totalReservations;
+    int bookedRooms;          // Rooms with at least one reservation
+    RoomTypeStats* types;     // Indexed by type id, like roomTypes
+    int typeCount;
+} HotelStats;
+
+// Fixed-size record allocator: items are carved from contiguous chunks
+// and recycled through a free list
+typedef struct PoolChunk {
+    struct PoolChunk* next;
+} PoolChunk;
+
+typedef struct MemoryPool {
+    size_t itemSize;
+    int itemsPerChunk;
+    void* freeList;
+    PoolChunk* chunks;
+    int chunkCount;
+    int inUse;
+} MemoryPool;
+
+typedef struct User {
+    char username[MAX_NAME_LEN];
+    char password[MAX_PASSWORD_LEN];
+    int isAdmin;
+    int id;                     // Numbered from 1 as users are added; not saved
+    Reservation* reservations;  // Newest first, linked through userNext
+    struct User* next;
+    struct User* prev;
+} User;
+
+extern User* userList;
+extern MemoryPool userPool;
+extern MemoryPool reservationPool;
+extern User** userTable;
+extern int userTableCapacity;
+extern int userTableCount;
+extern Reservation* reservationList;
+extern ReservationColumns reservationColumns;
+extern int orphanReservations;  // Reservations whose user does not exist
+extern Room* rooms;
+extern int totalRooms;
+extern int maxRooms;
+extern RoomType* roomTypes;
+extern int roomTypeCount;
+extern int roomTypeCapacity;
+extern HotelStats hotelStats;
+extern Reservation** expiryHeap;
+extern int expiryHeapSize;
+extern int expiryHeapCapacity;
+extern FILE* journalFile;
+extern int journalOpen;
+extern JournalBatch journalQueue;
+extern unsigned long long journalSequence;         // Last record queued
+extern unsigned long long journalDurableSequence;  // Last record known to be on disk
+extern unsigned long long journalFailedSequence;   // Last record of a write that failed
+extern PersistMode persistMode;
+extern int persistWindowMillis;
+extern int journalBackgroundWriter;
+extern unsigned int journalSegment;
+extern unsigned long long journalRecordsSinceSnapshot;
+extern unsigned long long journalBytesSinceSnapshot;
+extern RoomBookings* roomBookings;  // Parallel to rooms: roomBookings[i] belongs to rooms[i]
+extern int* roomTable;              // Room directory: room number to slot + 1
+extern int roomTableCapacity;
+extern int occupancyBaseDay;
+extern char snapshotFilePath[MAX_PATH_LEN];
+extern char journalFilePath[MAX_PATH_LEN];
+extern char oldJournalFilePath[MAX_PATH_LEN + 4];  // Segment waiting for a checkpoint to land
+extern char textFilePath[MAX_PATH_LEN];
+
+// Engine API: each call validates, applies the change and journals it
+HotelStatus hotelInit();
+void hotelShutdown();
+void hotelSetDataFiles(const char prefix[]);
+void hotelSetPersistence(PersistMode mode, int windowMillis, int backgroundWriter);
+void hotelSetSnapshotTriggers(unsigned long long everyRecords, unsigned long long everyBytes);
+void hotelSetLoaderThreads(int threads);
+HotelStatus hotelBook(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+HotelStatus hotelCheckBooking(int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+void hotelCommitBooking(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+void commitBooking(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, int locked);
+HotelStatus hotelBookGroup(char username[], GroupBooking bookings[], int count, int* failedIndex);
+int groupConflict(GroupBooking bookings[], int assigned[], int count, int roomNumber);
+HotelStatus hotelCancel(char username[], int roomNumber);
+HotelStatus hotelModify(Reservation* reservation, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+HotelStatus hotelRegister(char username[], char password[], int isAdmin);
+HotelStatus hotelDeleteUser(char username[]);
+HotelStatus hotelChangePassword(char username[], char newPassword[]);
+HotelStatus hotelCreateRoom(int roomNumber, char roomType[], double pricePerNight);
+HotelStatus hotelCreateRoomRange(int firstRoom, int lastRoom, char roomType[], double pricePerNight);
+HotelStatus hotelSetRoomRate(char roomType[], double pricePerNight);
+HotelStatus hotelSave();
+HotelStatus hotelConvert(int toText, const char inputPath[], const char outputPath[]);
+const char* hotelStatusMessage(HotelStatus status);
+
+// Users
+void addUser(char username[], char password[], int isAdmin);
+User* authenticateUser(char username[], char password[]);
+User* findUser(char username[]);
+int findUserSlot(char username[]);
+unsigned int hashUsername(const char username[]);
+void insertUserIndex(User* user);
+void removeUserIndex(User* user);
+void removeUser(User* user);
+
+// Reservations and rooms
+Reservation* addReservation(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+void updateReservationDates(Reservation* reservation, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+void moveReservation(Reservation* reservation, int roomNumber);
+void deleteReservation(Reservation* reservation);
+Reservation* findReservation(int roomNumber, int checkInDay, int checkInMinute);
+Reservation* findExactReservation(char username[], int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute);
+Reservation* findUserReservation(char username[], int roomNumber);
+Reservation* getUserReservations(char username[]);
+void linkUserReservation(User* user, Reservation* reservation);
+void unlinkUserReservation(User* user, Reservation* reservation);
+void adoptOrphanReservations(User* user);
+void initializeRooms();
+void resizeRooms();
+Room* findRoom(int roomNumber);
+int findRoomSlot(int roomNumber);
+unsigned int hashRoomNumber(int roomNumber);
+void growRoomTable(int minRooms);
+int insertRoom(int roomNumber, int typeId);
+void setRoom(int roomNumber, char roomType[], double pricePerNight);
+void restoreRoom(int roomNumber, char roomType[], double pricePerNight);
+void setRoomTypeRate(int typeId, double pricePerNight);
+void cleanup();
+
+// Availability
+int isRoomBooked(int roomNumber);
+int isRoomAvailableForDates(int roomNumber, int checkInDay, int checkOutDay);
+int isRoomAvailableExcluding(int roomNumber, int checkInDay, int checkOutDay, Reservation* exclude);
+RoomBookings* getRoomBookings(int roomNumber, int create);
+int findBookingPosition(RoomBookings* bookings, int day);
+void indexReservation(Reservation* reservation);
+void unindexReservation(Reservation* reservation);
+void setOccupancy(RoomBookings* bookings, int fromDay, int toDay, int booked);
+void markOccupancy(RoomBookings* bookings, int fromDay, int toDay);
+int buildOccupancyMask(int fromDay, int toDay, unsigned long long mask[], int* firstWord, int* lastWord);
+void advanceOccupancyHorizon(int today);
+int searchRooms(char roomType[], int checkInDay, int checkOutDay, int roomNumbers[], int maxResults);
+int findEarliestSlot(const char roomType[], int roomNumber, int fromDay, int nights, int* checkInDay);
+int earliestFreeDay(RoomBookings* bookings, int fromDay, int days, int limitDay);
+int searchFreeRuns(const RoomBookings* bookings, int node, int first, int span, int start, int limit, int days, int* carry);
+int searchFreeWord(unsigned long long word, int first, int start, int limit, int days, int* carry);
+int findFreeRunInIndex(RoomBookings* bookings, int fromDay, int days);
+void buildFreeRuns(RoomBookings* bookings);
+void updateFreeRuns(RoomBookings* bookings, int firstWord, int lastWord);
+int storeFreeRun(FreeRun* node, FreeRun run);
+FreeRun summarizeFreeWord(unsigned long long bits);
+
+// Column store
+void addReservationRow(Reservation* reservation);
+void updateReservationRow(Reservation* reservation);
+void removeReservationRow(Reservation* reservation);
+void compactReservationColumns();
+void clearReservationRows(int first, int last);
+int scanReservations(const ReservationFilter* filter, Reservation* results[], int maxResults);
+int countReservations(const ReservationFilter* filter);
+int matchReservationBlock(const ReservationFilter* filter, int first, unsigned char match[]);
+int dateStamp(int day, int minute);
+
+// Room-type catalog
+int findRoomType(const char name[]);
+int defineRoomType(const char name[], double pricePerNight);
+int internRoomType(const char name[]);
+void addRoomTypeSlot(int typeId, int slot);
+void removeRoomTypeSlot(int typeId, int slot);
+
+// Statistics
+void countRoomStats(int roomNumber, int sign);
+
+// Expiry
+int checkExpiredReservations();
+int expireReservations(int today, int minute);
+void dropArchivedReservations();
+int expiresBefore(Reservation* a, Reservation* b);
+void swapHeapEntries(int i, int j);
+void siftExpiryUp(int index);
+void siftExpiryDown(int index);
+void scheduleExpiry(Reservation* reservation);
+void unscheduleExpiry(Reservation* reservation);
+
+// Memory pools
+void* poolAlloc(MemoryPool* pool);
+void poolFree(MemoryPool* pool, void* item);
+void poolRelease(MemoryPool* pool);
+
+// Persistence
+int saveData();
+int captureSnapshot(SnapshotImage* image);
+int writeSnapshot(SnapshotImage* image);
+void markSnapshotDurable(unsigned long long sequence);
+int snapshotDue();
+void loadData();
+int loadTextSnapshot(const char path[]);
+int saveTextSnapshot(const char path[]);
+int loadBinarySnapshot(const char path[]);
+int saveBinarySnapshot(const char path[]);
+void buildSnapshotImage(SnapshotImage* image);
+int writeSnapshotImage(SnapshotImage* image, const char path[]);
+void freeSnapshotImage(SnapshotImage* image);
+unsigned int snapshotChecksum(unsigned int hash, const void* data, size_t size);
+int replaceFile(const char temporaryPath[], const char path[]);
+void openJournal();
+void closeJournal();
+int rotateJournal();
+long appendJournalSegment(const char fromPath[], const char toPath[]);
+int truncateJournalSegment(const char path[], long length);
+void journalRecord(const char* format, ...);
+void journalCommit();
+int flushJournal();
+void takeJournalBatch(JournalBatch* batch);
+int writeJournalBatch(JournalBatch* batch);
+void replayJournal();
+void replayJournalFile(const char path[], unsigned int coveredSegment);
+int replayJournalGroup(FILE* file, int groupSize);
+void replayJournalRecord(char line[]);
+
+// Dates and times
+int isValidDate(char date[]);
+int isValidTime(char time[]);
+int isLeapYear(int year);
+int monthLength(int year, int month);
+int compareDateTime(int day1, int minute1, int day2, int minute2);
+int dateToDay(char date[]);
+int daysFromCivil(int year, int month, int day);
+int timeToMinute(char time[]);
+void dayToDate(int day, char date[]);
+void civilFromDays(int day, int* year, int* month, int* dayOfMonth);
+void minuteToTime(int minute, char time[]);
+void getCurrentDateTime(int* day, int* minute);
+char* formatDateTime(int day, int minute);
+int parseDateTime(char date[], char time[], int* day, int* minute);
+
+// Bit scans over occupancy words, inline so the word loops stay tight
+static inline int highestBit(unsigned long long bits) {
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(bits);
+#else
+    int bit = 63;
+    while ((bits >> bit) == 0) {
+        bit--;
+    }
+    return bit;
+#endif
+}
+
+static inline int lowestBit(unsigned long long bits) {
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (((bits >> bit) & 1) == 0) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+#endif
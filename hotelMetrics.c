@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelMetrics.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define atomicAdd(target, value) _InterlockedExchangeAdd64((volatile long long*)(target), (long long)(value))
+#define atomicStore(target, value) _InterlockedExchange64((volatile long long*)(target), (long long)(value))
+#define atomicLoad(target) (*(volatile unsigned long long*)(target))
+#define atomicSwapIfEqual(target, expected, value) \
+    (_InterlockedCompareExchange64((volatile long long*)(target), (long long)(value), (long long)*(expected)) == (long long)*(expected))
+#else
+#define atomicAdd(target, value) __atomic_fetch_add((target), (value), __ATOMIC_RELAXED)
+#define atomicStore(target, value) __atomic_store_n((target), (value), __ATOMIC_RELAXED)
+#define atomicLoad(target) __atomic_load_n((target), __ATOMIC_RELAXED)
+#define atomicSwapIfEqual(target, expected, value) \
+    __atomic_compare_exchange_n((target), (expected), (value), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+LatencyHistogram metricHistograms[METRIC_OPERATION_COUNT];
+unsigned long long metricCounters[METRIC_COUNTER_COUNT];
+
+// Monotonic time in nanoseconds
+unsigned long long metricsClock() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (unsigned long long)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (unsigned long long)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+// Count one call of an operation that started at startNanos
+void metricsRecord(MetricOperation operation, unsigned long long startNanos) {
+    LatencyHistogram* histogram = &metricHistograms[operation];
+    unsigned long long nanos = metricsClock() - startNanos;
+    unsigned long long max = atomicLoad(&histogram->maxNanos);
+
+    atomicAdd(&histogram->buckets[histogramBucket(nanos)], 1);
+    atomicAdd(&histogram->count, 1);
+    atomicAdd(&histogram->totalNanos, nanos);
+    while (nanos > max && !atomicSwapIfEqual(&histogram->maxNanos, &max, nanos)) {
+        max = atomicLoad(&histogram->maxNanos);
+    }
+}
+
+void metricsAdd(MetricCounter counter, unsigned long long value) {
+    atomicAdd(&metricCounters[counter], value);
+}
+
+void metricsSet(MetricCounter counter, unsigned long long value) {
+    atomicStore(&metricCounters[counter], value);
+}
+
+void metricsReset() {
+    memset(metricHistograms, 0, sizeof(metricHistograms));
+    memset(metricCounters, 0, sizeof(metricCounters));
+}
+
+const char* metricName(MetricOperation operation) {
+    static const char* names[METRIC_OPERATION_COUNT] = {
+        "book", "group_book", "modify", "cancel", "availability",
+        "search", "scan", "expiry", "save", "snapshot_capture", "load", "journal_sync",
+        "archive_scan", "report", "best_fit", "reoptimize",
+        "earliest_slot"
+    };
+    return names[operation];
+}
+
+int histogramBucket(unsigned long long nanos) {
+    int exponent = 0;
+
+    if (nanos < HISTOGRAM_SUB_BUCKETS) {
+        return (int)nanos;
+    }
+    if (nanos >= (1ULL << HISTOGRAM_MAX_EXPONENT)) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+
+#ifdef __GNUC__
+    exponent = 63 - __builtin_clzll(nanos);
+#else
+    while ((nanos >> (exponent + 1)) != 0) {
+        exponent++;
+    }
+#endif
+    // Bucket group by exponent, then the four bits below the leading one
+    return (exponent - 3) * HISTOGRAM_SUB_BUCKETS + (int)((nanos >> (exponent - 4)) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+// Highest value that falls into a bucket
+unsigned long long histogramBucketValue(int bucket) {
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return (unsigned long long)bucket;
+    }
+
+    int exponent = bucket / HISTOGRAM_SUB_BUCKETS + 3;
+    unsigned long long subBucket = (unsigned long long)(bucket % HISTOGRAM_SUB_BUCKETS);
+    return ((HISTOGRAM_SUB_BUCKETS + subBucket + 1) << (exponent - 4)) - 1;
+}
+
+// Value at or below which the given fraction (0..1) of calls completed
+unsigned long long histogramPercentile(const LatencyHistogram* histogram, double percentile) {
+    unsigned long long target = (unsigned long long)(percentile * histogram->count + 0.5);
+    unsigned long long seen = 0;
+    int i;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+    if (target < 1) {
+        target = 1;
+    }
+    for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= target) {
+            unsigned long long value = histogramBucketValue(i);
+            return value < histogram->maxNanos ? value : histogram->maxNanos;
+        }
+    }
+    return histogram->maxNanos;
+}
+
+// Write counters, latency percentiles (microseconds) and structure sizes as JSON
+int metricsDumpJson(const char path[]) {
+    FILE* file = fopen(path, "w");
+    int i;
+
+    if (file == NULL) {
+        return 0;
+    }
+
+    fprintf(file, "{\n  \"operations\": {\n");
+    for (i = 0; i < METRIC_OPERATION_COUNT; i++) {
+        const LatencyHistogram* histogram = &metricHistograms[i];
+        fprintf(file, "    \"%s\": {\"count\": %llu, \"mean_us\": %.3f, \"p50_us\": %.3f, \"p90_us\": %.3f, "
+                "\"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f}%s\n",
+                metricName((MetricOperation)i), histogram->count,
+                histogram->count > 0 ? histogram->totalNanos / 1000.0 / histogram->count : 0.0,
+                histogramPercentile(histogram, 0.50) / 1000.0,
+                histogramPercentile(histogram, 0.90) / 1000.0,
+                histogramPercentile(histogram, 0.99) / 1000.0,
+                histogramPercentile(histogram, 0.999) / 1000.0,
+                histogram->maxNanos / 1000.0,
+                i + 1 < METRIC_OPERATION_COUNT ? "," : "");
+    }
+
+    fprintf(file, "  },\n  \"counters\": {\n");
+    fprintf(file, "    \"save_bytes\": %llu,\n", metricCounters[COUNTER_SAVE_BYTES]);
+    fprintf(file, "    \"last_save_bytes\": %llu,\n", metricCounters[COUNTER_LAST_SAVE_BYTES]);
+    fprintf(file, "    \"journal_records\": %llu,\n", metricCounters[COUNTER_JOURNAL_RECORDS]);
+    fprintf(file, "    \"journal_bytes\": %llu,\n", metricCounters[COUNTER_JOURNAL_BYTES]);
+    fprintf(file, "    \"expired_reservations\": %llu,\n", metricCounters[COUNTER_EXPIRED]);
+    fprintf(file, "    \"archived_reservations\": %llu,\n", metricCounters[COUNTER_ARCHIVED]);
+    fprintf(file, "    \"archive_bytes\": %llu,\n", metricCounters[COUNTER_ARCHIVE_BYTES]);
+    fprintf(file, "    \"reassigned_reservations\": %llu\n", metricCounters[COUNTER_REASSIGNED]);
+
+    fprintf(file, "  },\n  \"sizes\": {\n");
+    fprintf(file, "    \"rooms\": %d,\n", totalRooms);
+    fprintf(file, "    \"room_table_capacity\": %d,\n", roomTableCapacity);
+    fprintf(file, "    \"reservations\": %d,\n", hotelStats.totalReservations);
+    fprintf(file, "    \"orphan_reservations\": %d,\n", orphanReservations);
+    fprintf(file, "    \"reservation_rows\": %d,\n", reservationColumns.count);
+    fprintf(file, "    \"reservation_tombstones\": %d,\n", reservationColumns.tombstones);
+    fprintf(file, "    \"users\": %d,\n", userTableCount);
+    fprintf(file, "    \"user_table_capacity\": %d,\n", userTableCapacity);
+    fprintf(file, "    \"expiry_heap\": %d,\n", expiryHeapSize);
+    fprintf(file, "    \"expiry_heap_capacity\": %d,\n", expiryHeapCapacity);
+    fprintf(file, "    \"archive_partitions\": %d,\n", archivePartitionCount);
+    fprintf(file, "    \"reservation_pool_chunks\": %d,\n", reservationPool.chunkCount);
+    fprintf(file, "    \"user_pool_chunks\": %d\n", userPool.chunkCount);
+    fprintf(file, "  }\n}\n");
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,71 @@
+#ifndef HOTEL_METRICS_H
+#define HOTEL_METRICS_H
+
+// Always-on operation counters and latency histograms for the engine entry
+// points. Updates are relaxed atomic adds, so the server's worker threads
+// can record without taking a lock.
+
+#define METRICS_FILE "hotel_metrics.json"
+
+// Log-linear buckets in the style of HdrHistogram: values below 16 ns get a
+// bucket each, above that every power of two is split into 16 sub-buckets,
+// which keeps the error of any reported percentile under 1/16 (6.25%).
+#define HISTOGRAM_SUB_BUCKETS 16
+#define HISTOGRAM_MAX_EXPONENT 40  // 2^40 ns is about 18 minutes
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_EXPONENT - 3) * HISTOGRAM_SUB_BUCKETS)
+
+typedef enum MetricOperation {
+    METRIC_BOOK = 0,
+    METRIC_GROUP_BOOK,
+    METRIC_MODIFY,
+    METRIC_CANCEL,
+    METRIC_AVAILABILITY,
+    METRIC_SEARCH,
+    METRIC_SCAN,              // Column scans behind reservation lists and counts
+    METRIC_EXPIRY,
+    METRIC_SAVE,
+    METRIC_SNAPSHOT_CAPTURE,  // Part of a save that holds the engine still
+    METRIC_LOAD,
+    METRIC_JOURNAL_SYNC,
+    METRIC_ARCHIVE_SCAN,
+    METRIC_REPORT,            // Occupancy and revenue queries
+    METRIC_BEST_FIT,          // Bookings that let the engine pick the room
+    METRIC_REOPTIMIZE,
+    METRIC_EARLIEST_SLOT,     // Earliest dates a stay fits
+    METRIC_OPERATION_COUNT
+} MetricOperation;
+
+typedef enum MetricCounter {
+    COUNTER_SAVE_BYTES = 0,    // Snapshot bytes written, all saves
+    COUNTER_LAST_SAVE_BYTES,   // Size of the latest snapshot
+    COUNTER_JOURNAL_RECORDS,
+    COUNTER_JOURNAL_BYTES,
+    COUNTER_EXPIRED,           // Reservations removed by expiry
+    COUNTER_ARCHIVED,          // Expired reservations written to the archive
+    COUNTER_ARCHIVE_BYTES,
+    COUNTER_REASSIGNED,        // Bookings moved to another room by re-optimization
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+typedef struct LatencyHistogram {
+    unsigned long long buckets[HISTOGRAM_BUCKETS];
+    unsigned long long count;
+    unsigned long long totalNanos;
+    unsigned long long maxNanos;
+} LatencyHistogram;
+
+extern LatencyHistogram metricHistograms[METRIC_OPERATION_COUNT];
+extern unsigned long long metricCounters[METRIC_COUNTER_COUNT];
+
+unsigned long long metricsClock();
+void metricsRecord(MetricOperation operation, unsigned long long startNanos);
+void metricsAdd(MetricCounter counter, unsigned long long value);
+void metricsSet(MetricCounter counter, unsigned long long value);
+void metricsReset();
+const char* metricName(MetricOperation operation);
+int histogramBucket(unsigned long long nanos);
+unsigned long long histogramBucketValue(int bucket);
+unsigned long long histogramPercentile(const LatencyHistogram* histogram, double percentile);
+int metricsDumpJson(const char path[]);
+
+#endif
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
+
+NightLedger* nightLedgers = NULL; // Parallel to roomTypes, grown as types appear
+int nightLedgerCount = 0;
+
+// First night the ledgers cover
+int reportBaseDay() {
+    return occupancyBaseDay - REPORT_HISTORY_DAYS;
+}
+
+// Totals of one room type ("all" or NULL for every type) over the nights
+// fromDay..toDay-1. Returns 0 for an unknown type or a range that is not
+// inside the report window.
+int occupancyReport(const char roomType[], int fromDay, int toDay, OccupancyReport* report) {
+    unsigned long long start = metricsClock();
+    int all = roomType == NULL || strcmp(roomType, "all") == 0;
+    int typeId = all ? -1 : findRoomType(roomType);
+    
+    memset(report, 0, sizeof(OccupancyReport));
+    if ((!all && typeId < 0) || fromDay >= toDay || fromDay < reportBaseDay() || toDay > reportBaseDay() + REPORT_DAYS) {
+        return 0;
+    }
+    
+    fillReport(typeId, fromDay, toDay, report);
+    metricsRecord(METRIC_REPORT, start);
+    return 1;
+}
+
+// The same figures for each day, week or month of a range; the first and
+// last periods are cut to the range. Returns the number of periods, or -1
+// if the range is refused or needs more than maxReports periods.
+int occupancySeries(const char roomType[], int fromDay, int toDay, ReportPeriod period,
+                    OccupancyReport reports[], int maxReports) {
+    unsigned long long start = metricsClock();
+    int all = roomType == NULL || strcmp(roomType, "all") == 0;
+    int typeId = all ? -1 : findRoomType(roomType);
+    int count = 0;
+    int day;
+    
+    if ((!all && typeId < 0) || fromDay >= toDay || fromDay < reportBaseDay() || toDay > reportBaseDay() + REPORT_DAYS) {
+        return -1;
+    }
+    
+    for (day = fromDay; day < toDay; count++) {
+        int end = periodEnd(day, period);
+        if (count == maxReports) {
+            return -1;
+        }
+        if (end > toDay) {
+            end = toDay;
+        }
+        memset(&reports[count], 0, sizeof(OccupancyReport));
+        fillReport(typeId, day, end, &reports[count]);
+        day = end;
+    }
+    
+    metricsRecord(METRIC_REPORT, start);
+    return count;
+}
+
+int parseReportPeriod(const char text[], ReportPeriod* period) {
+    if (strcmp(text, "day") == 0) {
+        *period = REPORT_DAY;
+    } else if (strcmp(text, "week") == 0) {
+        *period = REPORT_WEEK;
+    } else if (strcmp(text, "month") == 0) {
+        *period = REPORT_MONTH;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Add (sign = 1) or withdraw (sign = -1) the nights fromDay..toDay-1 of a
+// reservation still in memory
+void countStayNights(int typeId, int fromDay, int toDay, int sign) {
+    NightLedger* ledger = getNightLedger(typeId);
+    if (ledger != NULL) {
+        addRangeTree(&ledger->liveNights, fromDay, toDay, sign);
+    }
+}
+
+// Record the nights of a stay that has gone to the archive, at the rate the
+// archive stores for it
+void closeStayNights(int typeId, int checkInDay, int checkOutDay, double pricePerNight) {
+    NightLedger* ledger = getNightLedger(typeId);
+    int lastNight = stayEndNight(checkInDay, checkOutDay);
+    
+    if (ledger != NULL) {
+        addRangeTree(&ledger->closedNights, checkInDay, lastNight, 1);
+        addRangeTree(&ledger->closedRevenue, checkInDay, lastNight, (unsigned int)(pricePerNight * 100 + 0.5) / 100.0);
+    }
+}
+
+// Read back the archived stays that fall in the report window
+void loadClosedNights() {
+    scanArchive(reportBaseDay(), reportBaseDay() + REPORT_DAYS, addClosedArchiveStay, NULL);
+}
+
+void addClosedArchiveStay(const ArchiveRecord* record, void* context) {
+    (void)context;
+    if (record->roomType[0] != '\0') {
+        closeStayNights(internRoomType(record->roomType), record->checkInDay, record->checkOutDay, record->pricePerNight);
+    }
+}
+
+// Drop the first days of every ledger and open as many empty ones at the
+// end. The trees are rebuilt from their nightly values, which only happens
+// when the occupancy horizon moves on.
+void shiftNightLedgers(int days) {
+    RangeTree* trees[3];
+    double* nights = (double*)malloc(REPORT_DAYS * sizeof(double));
+    int i, j, night;
+    
+    if (nights == NULL) {
+        return;
+    }
+    for (i = 0; i < nightLedgerCount; i++) {
+        trees[0] = &nightLedgers[i].liveNights;
+        trees[1] = &nightLedgers[i].closedNights;
+        trees[2] = &nightLedgers[i].closedRevenue;
+        for (j = 0; j < 3; j++) {
+            for (night = 0; night < REPORT_DAYS; night++) {
+                int position = night + days;
+                nights[night] = position < REPORT_DAYS ?
+                                prefixRangeTree(trees[j], position + 1) - prefixRangeTree(trees[j], position) : 0;
+            }
+            memset(trees[j]->base, 0, (REPORT_DAYS + 2) * sizeof(double));
+            memset(trees[j]->scaled, 0, (REPORT_DAYS + 2) * sizeof(double));
+            for (night = 0; night < REPORT_DAYS; night++) {
+                if (nights[night] != 0) {
+                    addTreeRange(trees[j], night + 1, night + 1, nights[night]);
+                }
+            }
+        }
+    }
+    free(nights);
+}
+
+void freeNightLedgers() {
+    int i;
+    for (i = 0; i < nightLedgerCount; i++) {
+        free(nightLedgers[i].liveNights.base);
+        free(nightLedgers[i].liveNights.scaled);
+        free(nightLedgers[i].closedNights.base);
+        free(nightLedgers[i].closedNights.scaled);
+        free(nightLedgers[i].closedRevenue.base);
+        free(nightLedgers[i].closedRevenue.scaled);
+    }
+    free(nightLedgers);
+    nightLedgers = NULL;
+    nightLedgerCount = 0;
+}
+
+// Ledger of a room type, allocating ledgers up to it on first use
+NightLedger* getNightLedger(int typeId) {
+    if (typeId < 0 || typeId >= roomTypeCount) {
+        return NULL;
+    }
+    
+    if (typeId >= nightLedgerCount) {
+        NightLedger* ledgers = (NightLedger*)realloc(nightLedgers, roomTypeCount * sizeof(NightLedger));
+        if (ledgers == NULL) {
+            return NULL;
+        }
+        nightLedgers = ledgers;
+        
+        for (; nightLedgerCount < roomTypeCount; nightLedgerCount++) {
+            NightLedger* ledger = &nightLedgers[nightLedgerCount];
+            ledger->liveNights.base = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+            ledger->liveNights.scaled = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+            ledger->closedNights.base = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+            ledger->closedNights.scaled = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+            ledger->closedRevenue.base = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+            ledger->closedRevenue.scaled = (double*)calloc(REPORT_DAYS + 2, sizeof(double));
+        }
+    }
+    
+    NightLedger* ledger = &nightLedgers[typeId];
+    if (ledger->liveNights.base == NULL || ledger->liveNights.scaled == NULL ||
+        ledger->closedNights.base == NULL || ledger->closedNights.scaled == NULL ||
+        ledger->closedRevenue.base == NULL || ledger->closedRevenue.scaled == NULL) {
+        return NULL;
+    }
+    return ledger;
+}
+
+// Day after the last night of a stay; a same-day stay is charged one night
+int stayEndNight(int checkInDay, int checkOutDay) {
+    return checkOutDay > checkInDay ? checkOutDay : checkInDay + 1;
+}
+
+// Add value to each of the nights fromDay..toDay-1 that fall in the window
+void addRangeTree(RangeTree* tree, int fromDay, int toDay, double value) {
+    int first = fromDay - reportBaseDay() + 1;
+    int last = toDay - reportBaseDay();
+    
+    if (first < 1) {
+        first = 1;
+    }
+    if (last > REPORT_DAYS) {
+        last = REPORT_DAYS;
+    }
+    if (first <= last) {
+        addTreeRange(tree, first, last, value);
+    }
+}
+
+// Add value to window positions first..last, counted from 1
+void addTreeRange(RangeTree* tree, int first, int last, double value) {
+    addTreeEntry(tree->base, first, value);
+    addTreeEntry(tree->base, last + 1, -value);
+    addTreeEntry(tree->scaled, first, value * (first - 1));
+    addTreeEntry(tree->scaled, last + 1, -value * last);
+}
+
+// Total over the nights fromDay..toDay-1, which must be inside the window
+double sumRangeTree(const RangeTree* tree, int fromDay, int toDay) {
+    return prefixRangeTree(tree, toDay - reportBaseDay()) - prefixRangeTree(tree, fromDay - reportBaseDay());
+}
+
+// Total over the first nights of the window
+double prefixRangeTree(const RangeTree* tree, int nights) {
+    return sumTreeEntries(tree->base, nights) * nights - sumTreeEntries(tree->scaled, nights);
+}
+
+void addTreeEntry(double tree[], int position, double value) {
+    for (; position <= REPORT_DAYS + 1; position += position & -position) {
+        tree[position] += value;
+    }
+}
+
+double sumTreeEntries(const double tree[], int position) {
+    double sum = 0;
+    for (; position > 0; position -= position & -position) {
+        sum += tree[position];
+    }
+    return sum;
+}
+
+// Figures for one type, or every type if typeId is -1
+void fillReport(int typeId, int fromDay, int toDay, OccupancyReport* report) {
+    int days = toDay - fromDay;
+    int i;
+    
+    report->fromDay = fromDay;
+    report->toDay = toDay;
+    for (i = 0; i < roomTypeCount; i++) {
+        if (typeId >= 0 && i != typeId) {
+            continue;
+        }
+        report->rooms += roomTypes[i].roomCount;
+        
+        NightLedger* ledger = i < nightLedgerCount ? &nightLedgers[i] : NULL;
+        if (ledger == NULL || ledger->liveNights.base == NULL) {
+            continue;
+        }
+        double liveNights = sumRangeTree(&ledger->liveNights, fromDay, toDay);
+        report->roomNights += liveNights + sumRangeTree(&ledger->closedNights, fromDay, toDay);
+        report->revenue += liveNights * roomTypes[i].pricePerNight + sumRangeTree(&ledger->closedRevenue, fromDay, toDay);
+    }
+    
+    double roomDays = (double)report->rooms * days;
+    report->occupancy = roomDays > 0 ? report->roomNights * 100 / roomDays : 0;
+    report->adr = report->roomNights > 0 ? report->revenue / report->roomNights : 0;
+    report->revpar = roomDays > 0 ? report->revenue / roomDays : 0;
+}
+
+// First day after the period that day falls in
+int periodEnd(int day, ReportPeriod period) {
+    if (period == REPORT_WEEK) {
+        // 1970-01-01 was a Thursday
+        return day - ((day + 3) % 7 + 7) % 7 + 7;
+    }
+    if (period == REPORT_MONTH) {
+        return monthStartDay(dayToMonth(day) + 1);
+    }
+    return day + 1;
+}
@@ -0,0 +1,82 @@
+#ifndef HOTEL_REPORT_H
+#define HOTEL_REPORT_H
+
+// Occupancy and revenue over any range of nights. Each room type keeps a
+// ledger of the nights it has sold, one entry per night of the report
+// window: the REPORT_HISTORY_DAYS before the occupancy horizon and the
+// horizon itself. The ledgers are Fenwick trees that take a stay as one
+// update over its nights and sum any range of nights, both in O(log n), so
+// a report never walks the reservations.
+//
+// Nights of reservations still in memory are charged at their type's
+// current rate; nights of stays that have checked out are charged at the
+// rate the archive recorded for them, and are read back from the archive
+// at startup. Occupancy is against the rooms the hotel has now.
+
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+
+#define REPORT_HISTORY_DAYS 384  // Days kept before the occupancy horizon, a multiple of 64
+#define REPORT_DAYS (REPORT_HISTORY_DAYS + OCCUPANCY_DAYS)
+#define REPORT_MAX_PERIODS 400   // Most periods one series may be split into
+
+// Pair of Fenwick trees over the report window that add a value to every
+// night of a range and give the total over any range
+typedef struct RangeTree {
+    double* base;    // Value added from a night on
+    double* scaled;  // Same, times the night before it, to correct prefix sums
+} RangeTree;
+
+// Nights sold by one room type, indexed like roomTypes
+typedef struct NightLedger {
+    RangeTree liveNights;     // Reservations still in memory
+    RangeTree closedNights;   // Stays moved to the archive
+    RangeTree closedRevenue;  // What those stays were charged
+} NightLedger;
+
+typedef enum ReportPeriod {
+    REPORT_DAY = 0,
+    REPORT_WEEK,    // Monday to Sunday
+    REPORT_MONTH
+} ReportPeriod;
+
+// Figures for the nights fromDay..toDay-1
+typedef struct OccupancyReport {
+    int fromDay;
+    int toDay;
+    int rooms;
+    double roomNights;
+    double revenue;
+    double occupancy;  // Percent of the rooms' nights that were sold
+    double adr;        // Average daily rate: revenue per night sold
+    double revpar;     // Revenue per available room night
+} OccupancyReport;
+
+extern NightLedger* nightLedgers;
+extern int nightLedgerCount;
+
+int reportBaseDay();
+int occupancyReport(const char roomType[], int fromDay, int toDay, OccupancyReport* report);
+int occupancySeries(const char roomType[], int fromDay, int toDay, ReportPeriod period,
+                    OccupancyReport reports[], int maxReports);
+int parseReportPeriod(const char text[], ReportPeriod* period);
+
+void countStayNights(int typeId, int fromDay, int toDay, int sign);
+void closeStayNights(int typeId, int checkInDay, int checkOutDay, double pricePerNight);
+void loadClosedNights();
+void shiftNightLedgers(int days);
+void freeNightLedgers();
+
+NightLedger* getNightLedger(int typeId);
+int stayEndNight(int checkInDay, int checkOutDay);
+void addClosedArchiveStay(const ArchiveRecord* record, void* context);
+void addRangeTree(RangeTree* tree, int fromDay, int toDay, double value);
+void addTreeRange(RangeTree* tree, int first, int last, double value);
+double sumRangeTree(const RangeTree* tree, int fromDay, int toDay);
+double prefixRangeTree(const RangeTree* tree, int night);
+void addTreeEntry(double tree[], int position, double value);
+double sumTreeEntries(const double tree[], int position);
+void fillReport(int typeId, int fromDay, int toDay, OccupancyReport* report);
+int periodEnd(int day, ReportPeriod period);
+
+#endif
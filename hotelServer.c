@@ -0,0 +1,805 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hotelThreads.h"
+#include "hotelEngine.h"
+#include "hotelAssign.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
+
+// Reservation server: serves many clients over loopback TCP, one thread per
+// connection. Requests and replies are single text lines:
+//
+//   LOGIN <user> <password>                          -> OK USER | OK ADMIN
+//   SEARCH <type|all> <in date> <out date>           -> OK <count> <room>...
+//   EARLIEST <room|type|all> <from date> <nights>    -> OK <in date> <room>, the first check-in the stay fits
+//   BOOK <room> <in date> <in time> <out date> <out time>
+//   BOOK <type> <in date> <in time> <out date> <out time>  -> OK <room>, the best fitting room of the type
+//   MODIFY <room> <in date> <in time> <out date> <out time>
+//   GROUP <in date> <in time> <out date> <out time> <room|type>...   -> OK <room>...
+//   CANCEL <room>
+//   STATS                                            -> OK <rooms> <booked> <reservations>
+//   OCCUPANCY <type|all> <from date> <to date>       -> OK <rooms> <nights> <occupancy %> <ADR> <RevPAR> <revenue>
+//   REOPTIMIZE <type|all>                            -> OK <moved> <orphan days before> <after> (admin only)
+//   RATE <type> <price>                              -> OK, the new nightly rate of every room of the type (admin only)
+//   SYNC                                             -> OK <last durable journal record>
+//   SAVE, METRICS, SHUTDOWN (admin only), QUIT
+//
+// Failures reply "ERR <message>". Bookings act on the logged-in user.
+//
+// Persistence: a journal thread writes the queued journal records once per
+// window with one write and one fsync (group commit). In strict mode a
+// mutation is answered only after its record is on disk; in relaxed mode as
+// soon as it is queued, and SYNC waits for everything queued so far.
+// Checkpoints (SAVE, and a background one whenever the journal has grown
+// enough) hold the engine only while the state is copied into memory; the
+// snapshot file is written while mutations carry on.
+//
+// Locking: rooms are spread over SHARD_COUNT reader/writer locks and every
+// structure shared between rooms (reservation list, users, statistics,
+// expiry heap, pools, journal queue) sits behind engineMutex. Locks are always
+// taken in the order: snapshotMutex, journalWriteMutex, room shards in
+// ascending index, then engineMutex. durableMutex is only ever held on its own.
+// Availability checks only hold the room's shard, so bookings for rooms in
+// different shards run in parallel and only meet for the short commit.
+
+#define DEFAULT_PORT 5050
+#define SHARD_COUNT 64
+#define MAX_REQUEST_LEN 512
+#define MAX_REPLY_LEN 1024
+#define MAX_ARGS 48
+#define MAX_SEARCH_RESULTS 64
+#define EXPIRY_INTERVAL 60  // Seconds between expiry sweeps
+
+typedef struct Session {
+    HotelSocket socket;
+    char username[MAX_NAME_LEN];
+    int loggedIn;
+    int isAdmin;
+} Session;
+
+HotelRWLock roomShards[SHARD_COUNT];
+HotelMutex engineMutex;
+HotelMutex snapshotMutex;      // One checkpoint at a time, held until its file is in place
+HotelMutex journalWriteMutex;  // Held while a batch is written or a snapshot replaces the journal
+HotelMutex durableMutex;       // Guards the sequence numbers below
+HotelCond journalQueued;       // Signalled when queuedSequence moves past writtenSequence
+HotelCond journalDurable;      // Broadcast when durableSequence or failedSequence moves
+unsigned long long queuedSequence = 0;   // Newest journal record a handler has reported
+unsigned long long writtenSequence = 0;  // Newest journal record the journal thread has tried to write
+unsigned long long durableSequence = 0;  // Newest journal record on disk or in a snapshot
+unsigned long long failedSequence = 0;   // Newest journal record whose write failed
+int snapshotRunning = 0;                 // A background checkpoint was started; guarded by engineMutex
+volatile int serverRunning = 1;
+
+int shardOf(int roomNumber);
+void lockAllShards(int exclusive);
+void unlockAllShards(int exclusive);
+int splitRequest(char line[], char* args[]);
+int sendReply(HotelSocket socket, const char reply[]);
+void replyStatus(char reply[], HotelStatus status);
+void handleRequest(Session* session, int argc, char* args[], char reply[]);
+void handleBook(Session* session, int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, char reply[]);
+void handleModify(Session* session, int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, char reply[]);
+void handleCancel(Session* session, int roomNumber, char reply[]);
+void handleGroup(Session* session, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute,
+                 char* targets[], int count, char reply[]);
+void handleSearch(char roomType[], int checkInDay, int checkOutDay, char reply[]);
+void handleEarliest(char target[], int fromDay, int nights, char reply[]);
+void handleBestFit(Session* session, char roomType[], int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute,
+                   char reply[]);
+void handleReoptimize(char roomType[], char reply[]);
+void handleRate(char roomType[], double pricePerNight, char reply[]);
+int persistMutation(unsigned long long sequence, int wait);
+void markWritten(unsigned long long sequence, int success);
+void markDurable(unsigned long long sequence);
+void writeQueuedJournal(JournalBatch* batch);
+int takeSnapshot();
+HOTEL_THREAD_FUNC(serveClient, arg);
+HOTEL_THREAD_FUNC(expiryLoop, arg);
+HOTEL_THREAD_FUNC(journalLoop, arg);
+HOTEL_THREAD_FUNC(snapshotThread, arg);
+
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : DEFAULT_PORT;
+    PersistMode mode = argc > 3 && strcmp(argv[3], "relaxed") == 0 ? PERSIST_RELAXED : PERSIST_STRICT;
+    int windowMillis = argc > 4 ? atoi(argv[4]) : DEFAULT_PERSIST_WINDOW_MS;
+    unsigned long long checkpointRecords = argc > 5 ? strtoull(argv[5], NULL, 10) : SNAPSHOT_EVERY_RECORDS;
+    struct sockaddr_in address;
+    HotelSocket listener;
+    int reuse = 1;
+    int i;
+
+    if (argc > 2) {
+        hotelSetDataFiles(argv[2]);
+    }
+    if (!hotelSocketStartup()) {
+        fprintf(stderr, "Error: Could not initialize sockets\n");
+        return 1;
+    }
+
+    for (i = 0; i < SHARD_COUNT; i++) {
+        hotelRWLockInit(&roomShards[i]);
+    }
+    hotelMutexInit(&engineMutex);
+    hotelMutexInit(&snapshotMutex);
+    hotelMutexInit(&journalWriteMutex);
+    hotelMutexInit(&durableMutex);
+    hotelCondInit(&journalQueued);
+    hotelCondInit(&journalDurable);
+
+    hotelSetPersistence(mode, windowMillis, 1);
+    hotelSetSnapshotTriggers(checkpointRecords, SNAPSHOT_EVERY_BYTES);
+    if (hotelInit() != HOTEL_OK) {
+        fprintf(stderr, "Error: %s\n", hotelStatusMessage(HOTEL_ERR_IO));
+        return 1;
+    }
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == HOTEL_INVALID_SOCKET) {
+        fprintf(stderr, "Error: Could not create socket\n");
+        return 1;
+    }
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    // Only local clients: front desks and channel feeds run on this machine
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((unsigned short)port);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        fprintf(stderr, "Error: Could not listen on port %d\n", port);
+        return 1;
+    }
+
+    hotelThreadStart(expiryLoop, NULL);
+    hotelThreadStart(journalLoop, NULL);
+    printf("Listening on 127.0.0.1:%d (%s persistence, %d ms window)\n", port,
+           mode == PERSIST_STRICT ? "strict" : "relaxed", persistWindowMillis);
+    fflush(stdout);
+
+    while (serverRunning) {
+        HotelSocket client = accept(listener, NULL, NULL);
+        if (client == HOTEL_INVALID_SOCKET) {
+            continue;
+        }
+
+        Session* session = (Session*)calloc(1, sizeof(Session));
+        if (session == NULL) {
+            hotelCloseSocket(client);
+            continue;
+        }
+        session->socket = client;
+        if (!hotelThreadStart(serveClient, session)) {
+            hotelCloseSocket(client);
+            free(session);
+        }
+    }
+    return 0;
+}
+
+int shardOf(int roomNumber) {
+    return (roomNumber < 0 ? -roomNumber : roomNumber) % SHARD_COUNT;
+}
+
+// Take every shard in ascending order, for work that touches many rooms
+void lockAllShards(int exclusive) {
+    int i;
+    for (i = 0; i < SHARD_COUNT; i++) {
+        if (exclusive) {
+            hotelWriteLock(&roomShards[i]);
+        } else {
+            hotelReadLock(&roomShards[i]);
+        }
+    }
+}
+
+void unlockAllShards(int exclusive) {
+    int i;
+    for (i = SHARD_COUNT - 1; i >= 0; i--) {
+        if (exclusive) {
+            hotelWriteUnlock(&roomShards[i]);
+        } else {
+            hotelReadUnlock(&roomShards[i]);
+        }
+    }
+}
+
+HOTEL_THREAD_FUNC(serveClient, arg) {
+    Session* session = (Session*)arg;
+    char buffer[MAX_REQUEST_LEN];
+    char reply[MAX_REPLY_LEN];
+    char* args[MAX_ARGS];
+    int length = 0;
+
+    while (serverRunning) {
+        int received = recv(session->socket, buffer + length, sizeof(buffer) - 1 - length, 0);
+        if (received <= 0) {
+            break;
+        }
+        length += received;
+        buffer[length] = '\0';
+
+        // Handle every complete line; keep a partial one for the next recv
+        char* line = buffer;
+        char* end;
+        while ((end = strchr(line, '\n')) != NULL) {
+            *end = '\0';
+            if (end > line && end[-1] == '\r') {
+                end[-1] = '\0';
+            }
+
+            int count = splitRequest(line, args);
+            if (count > 0) {
+                if (strcmp(args[0], "QUIT") == 0) {
+                    sendReply(session->socket, "OK");
+                    length = -1;
+                    break;
+                }
+                handleRequest(session, count, args, reply);
+                if (!sendReply(session->socket, reply)) {
+                    length = -1;
+                    break;
+                }
+            }
+            line = end + 1;
+        }
+        if (length < 0) {
+            break;
+        }
+
+        length = (int)strlen(line);
+        if (length == sizeof(buffer) - 1) {
+            sendReply(session->socket, "ERR Request too long");
+            break;
+        }
+        memmove(buffer, line, length + 1);
+    }
+
+    hotelCloseSocket(session->socket);
+    free(session);
+    HOTEL_THREAD_RETURN;
+}
+
+// Drop expired reservations once a minute
+HOTEL_THREAD_FUNC(expiryLoop, arg) {
+    (void)arg;
+    while (serverRunning) {
+        hotelSleepSeconds(EXPIRY_INTERVAL);
+        lockAllShards(1);
+        hotelMutexLock(&engineMutex);
+        if (!checkExpiredReservations()) {
+            fprintf(stderr, "Error: Could not archive expired reservations\n");
+        }
+        hotelMutexUnlock(&engineMutex);
+        unlockAllShards(1);
+    }
+    HOTEL_THREAD_RETURN;
+}
+
+// Group commit: wait until some mutation is queued, give the others arriving
+// in the same window time to join it, then write them all at once
+HOTEL_THREAD_FUNC(journalLoop, arg) {
+    JournalBatch batch;
+    (void)arg;
+
+    memset(&batch, 0, sizeof(batch));
+    while (serverRunning) {
+        hotelMutexLock(&durableMutex);
+        while (queuedSequence <= writtenSequence) {
+            hotelCondWait(&journalQueued, &durableMutex);
+        }
+        hotelMutexUnlock(&durableMutex);
+
+        if (persistWindowMillis > 0) {
+            hotelSleepMillis(persistWindowMillis);
+        }
+        writeQueuedJournal(&batch);
+    }
+    HOTEL_THREAD_RETURN;
+}
+
+// Take the queue under the engine lock, write it without. Also the place
+// that notices the journal has grown enough for a checkpoint.
+void writeQueuedJournal(JournalBatch* batch) {
+    int startSnapshot = 0;
+    int success;
+    int gap;
+
+    hotelMutexLock(&journalWriteMutex);
+    hotelMutexLock(&engineMutex);
+    takeJournalBatch(batch);
+    if (!snapshotRunning && snapshotDue()) {
+        snapshotRunning = 1;
+        startSnapshot = 1;
+    }
+    hotelMutexUnlock(&engineMutex);
+    success = writeJournalBatch(batch);
+    hotelMutexUnlock(&journalWriteMutex);
+    markWritten(batch->lastSequence, success);
+    if (!success) {
+        fprintf(stderr, "Error: Could not write the journal\n");
+    }
+
+    // Only a checkpoint covers records that did not reach the journal, so
+    // one is tried after every write until one succeeds
+    hotelMutexLock(&durableMutex);
+    gap = failedSequence > durableSequence;
+    hotelMutexUnlock(&durableMutex);
+    if (gap) {
+        hotelMutexLock(&engineMutex);
+        if (!snapshotRunning) {
+            snapshotRunning = 1;
+            startSnapshot = 1;
+        }
+        hotelMutexUnlock(&engineMutex);
+    }
+    if (startSnapshot && !hotelThreadStart(snapshotThread, NULL)) {
+        hotelMutexLock(&engineMutex);
+        snapshotRunning = 0;
+        hotelMutexUnlock(&engineMutex);
+    }
+}
+
+// Write a checkpoint. The engine is held only while captureSnapshot copies
+// it into memory and starts a new journal segment; the file is written
+// after mutations have resumed.
+int takeSnapshot() {
+    SnapshotImage image;
+
+    hotelMutexLock(&snapshotMutex);
+    hotelMutexLock(&journalWriteMutex);
+    hotelMutexLock(&engineMutex);
+    int success = captureSnapshot(&image);
+    unsigned long long captured = journalSequence;
+    int flushed = journalDurableSequence == captured;
+    hotelMutexUnlock(&engineMutex);
+    hotelMutexUnlock(&journalWriteMutex);
+    markWritten(captured, flushed);
+
+    success = success && writeSnapshot(&image);
+    if (success) {
+        hotelMutexLock(&engineMutex);
+        markSnapshotDurable(captured);
+        hotelMutexUnlock(&engineMutex);
+        markDurable(captured);
+    }
+    hotelMutexUnlock(&snapshotMutex);
+    return success;
+}
+
+HOTEL_THREAD_FUNC(snapshotThread, arg) {
+    (void)arg;
+    if (!takeSnapshot()) {
+        fprintf(stderr, "Error: Background snapshot failed\n");
+    }
+    hotelMutexLock(&engineMutex);
+    snapshotRunning = 0;
+    hotelMutexUnlock(&engineMutex);
+    HOTEL_THREAD_RETURN;
+}
+
+// The journal thread is done with the records up to sequence. A failed
+// write leaves a gap in the journal, so until a checkpoint closes it no
+// later record counts as durable either.
+void markWritten(unsigned long long sequence, int success) {
+    hotelMutexLock(&durableMutex);
+    if (sequence > writtenSequence) {
+        writtenSequence = sequence;
+    }
+    if (!success && sequence > failedSequence) {
+        failedSequence = sequence;
+    }
+    if (success && failedSequence <= durableSequence && sequence > durableSequence) {
+        durableSequence = sequence;
+    }
+    hotelCondBroadcast(&journalDurable);
+    hotelMutexUnlock(&durableMutex);
+}
+
+// Records up to sequence are in a snapshot on disk, written or not to the journal
+void markDurable(unsigned long long sequence) {
+    hotelMutexLock(&durableMutex);
+    if (sequence > writtenSequence) {
+        writtenSequence = sequence;
+    }
+    if (sequence > durableSequence) {
+        durableSequence = sequence;
+        hotelCondBroadcast(&journalDurable);
+    }
+    hotelMutexUnlock(&durableMutex);
+}
+
+// Hand a mutation's journal records (up to sequence) to the journal thread.
+// With wait set, return only once they are on disk. Returns 0 if they could
+// not be written.
+int persistMutation(unsigned long long sequence, int wait) {
+    int success;
+
+    hotelMutexLock(&durableMutex);
+    if (sequence > queuedSequence) {
+        queuedSequence = sequence;
+        hotelCondSignal(&journalQueued);
+    }
+    while (wait && durableSequence < sequence && failedSequence <= durableSequence) {
+        hotelCondWait(&journalDurable, &durableMutex);
+    }
+    success = !wait || durableSequence >= sequence;
+    hotelMutexUnlock(&durableMutex);
+    return success;
+}
+
+// Split a request on spaces in place (strtok is not thread-safe)
+int splitRequest(char line[], char* args[]) {
+    int count = 0;
+
+    while (*line != '\0' && count < MAX_ARGS) {
+        while (*line == ' ' || *line == '\t') {
+            *line++ = '\0';
+        }
+        if (*line == '\0') {
+            break;
+        }
+        args[count++] = line;
+        while (*line != '\0' && *line != ' ' && *line != '\t') {
+            line++;
+        }
+    }
+    return count;
+}
+
+int sendReply(HotelSocket socket, const char reply[]) {
+    char line[MAX_REPLY_LEN + 1];
+    int length = snprintf(line, sizeof(line), "%s\n", reply);
+    int sent = 0;
+
+    if (length > (int)sizeof(line) - 1) {
+        length = sizeof(line) - 1;
+    }
+    while (sent < length) {
+        int written = send(socket, line + sent, length - sent, 0);
+        if (written <= 0) {
+            return 0;
+        }
+        sent += written;
+    }
+    return 1;
+}
+
+void replyStatus(char reply[], HotelStatus status) {
+    if (status == HOTEL_OK) {
+        strcpy(reply, "OK");
+    } else {
+        snprintf(reply, MAX_REPLY_LEN, "ERR %s", hotelStatusMessage(status));
+    }
+}
+
+void handleRequest(Session* session, int argc, char* args[], char reply[]) {
+    char* command = args[0];
+    int inDay, inMinute, outDay, outMinute;
+
+    if (strcmp(command, "LOGIN") == 0 && argc == 3) {
+        hotelMutexLock(&engineMutex);
+        User* user = authenticateUser(args[1], args[2]);
+        if (user != NULL) {
+            strcpy(session->username, user->username);
+            session->isAdmin = user->isAdmin;
+            session->loggedIn = 1;
+        }
+        hotelMutexUnlock(&engineMutex);
+
+        if (user == NULL) {
+            strcpy(reply, "ERR Invalid username or password");
+        } else {
+            strcpy(reply, session->isAdmin ? "OK ADMIN" : "OK USER");
+        }
+        return;
+    }
+    if (!session->loggedIn) {
+        strcpy(reply, "ERR Not logged in");
+        return;
+    }
+
+    if ((strcmp(command, "BOOK") == 0 || strcmp(command, "MODIFY") == 0) && argc == 6 &&
+        parseDateTime(args[2], args[3], &inDay, &inMinute) && parseDateTime(args[4], args[5], &outDay, &outMinute)) {
+        if (command[0] == 'B' && !isdigit((unsigned char)args[1][0])) {
+            handleBestFit(session, args[1], inDay, inMinute, outDay, outMinute, reply);
+        } else if (command[0] == 'B') {
+            handleBook(session, atoi(args[1]), inDay, inMinute, outDay, outMinute, reply);
+        } else {
+            handleModify(session, atoi(args[1]), inDay, inMinute, outDay, outMinute, reply);
+        }
+    } else if (strcmp(command, "GROUP") == 0 && argc >= 6 &&
+               parseDateTime(args[1], args[2], &inDay, &inMinute) && parseDateTime(args[3], args[4], &outDay, &outMinute)) {
+        handleGroup(session, inDay, inMinute, outDay, outMinute, args + 5, argc - 5, reply);
+    } else if (strcmp(command, "CANCEL") == 0 && argc == 2) {
+        handleCancel(session, atoi(args[1]), reply);
+    } else if (strcmp(command, "SEARCH") == 0 && argc == 4 &&
+               parseDateTime(args[2], NULL, &inDay, NULL) && parseDateTime(args[3], NULL, &outDay, NULL)) {
+        handleSearch(args[1], inDay, outDay, reply);
+    } else if (strcmp(command, "EARLIEST") == 0 && argc == 4 && parseDateTime(args[2], NULL, &inDay, NULL)) {
+        handleEarliest(args[1], inDay, atoi(args[3]), reply);
+    } else if (strcmp(command, "SYNC") == 0 && argc == 1) {
+        hotelMutexLock(&engineMutex);
+        unsigned long long sequence = journalSequence;
+        hotelMutexUnlock(&engineMutex);
+        if (persistMutation(sequence, 1)) {
+            hotelMutexLock(&durableMutex);
+            snprintf(reply, MAX_REPLY_LEN, "OK %llu", durableSequence);
+            hotelMutexUnlock(&durableMutex);
+        } else {
+            replyStatus(reply, HOTEL_ERR_IO);
+        }
+    } else if (strcmp(command, "STATS") == 0 && argc == 1) {
+        hotelMutexLock(&engineMutex);
+        snprintf(reply, MAX_REPLY_LEN, "OK %d %d %d", totalRooms, hotelStats.bookedRooms, hotelStats.totalReservations);
+        hotelMutexUnlock(&engineMutex);
+    } else if (strcmp(command, "OCCUPANCY") == 0 && argc == 4 &&
+               parseDateTime(args[2], NULL, &inDay, NULL) && parseDateTime(args[3], NULL, &outDay, NULL)) {
+        OccupancyReport report;
+
+        if (!session->isAdmin) {
+            strcpy(reply, "ERR Admin only");
+            return;
+        }
+
+        // The ledgers change with every booking, so read them under the engine lock
+        hotelMutexLock(&engineMutex);
+        int found = occupancyReport(args[1], inDay, outDay, &report);
+        hotelMutexUnlock(&engineMutex);
+        if (found) {
+            snprintf(reply, MAX_REPLY_LEN, "OK %d %.0f %.1f %.2f %.2f %.2f", report.rooms, report.roomNights,
+                     report.occupancy, report.adr, report.revpar, report.revenue);
+        } else {
+            strcpy(reply, "ERR Unknown room type or dates outside the report window");
+        }
+    } else if (strcmp(command, "REOPTIMIZE") == 0 && argc == 2) {
+        if (!session->isAdmin) {
+            strcpy(reply, "ERR Admin only");
+            return;
+        }
+        handleReoptimize(args[1], reply);
+    } else if (strcmp(command, "RATE") == 0 && argc == 3) {
+        if (!session->isAdmin) {
+            strcpy(reply, "ERR Admin only");
+            return;
+        }
+        handleRate(args[1], atof(args[2]), reply);
+    } else if (strcmp(command, "METRICS") == 0 && argc == 1) {
+        if (!session->isAdmin) {
+            strcpy(reply, "ERR Admin only");
+            return;
+        }
+
+        // Size figures are read from the engine, so hold it still while dumping
+        hotelMutexLock(&engineMutex);
+        int written = metricsDumpJson(METRICS_FILE);
+        hotelMutexUnlock(&engineMutex);
+        snprintf(reply, MAX_REPLY_LEN, written ? "OK %s" : "ERR Could not write %s", METRICS_FILE);
+    } else if ((strcmp(command, "SAVE") == 0 || strcmp(command, "SHUTDOWN") == 0) && argc == 1) {
+        if (!session->isAdmin) {
+            strcpy(reply, "ERR Admin only");
+            return;
+        }
+
+        if (command[1] == 'A') {
+            replyStatus(reply, takeSnapshot() ? HOTEL_OK : HOTEL_ERR_IO);
+            return;
+        }
+
+        // Shutting down frees the engine, so every shard is held exclusively to
+        // keep searches out; a background checkpoint finishes first
+        hotelMutexLock(&snapshotMutex);
+        hotelMutexLock(&journalWriteMutex);
+        lockAllShards(1);
+        hotelMutexLock(&engineMutex);
+        replyStatus(reply, hotelSave());
+        hotelShutdown();
+        sendReply(session->socket, reply);
+        exit(0);
+    } else {
+        strcpy(reply, "ERR Unknown command or wrong arguments");
+    }
+}
+
+void handleBook(Session* session, int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, char reply[]) {
+    HotelRWLock* shard = &roomShards[shardOf(roomNumber)];
+    unsigned long long start = metricsClock();
+    unsigned long long sequence = 0;
+
+    hotelWriteLock(shard);
+    HotelStatus status = hotelCheckBooking(roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+    if (status == HOTEL_OK) {
+        hotelMutexLock(&engineMutex);
+        hotelCommitBooking(session->username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+        sequence = journalSequence;
+        hotelMutexUnlock(&engineMutex);
+    }
+    hotelWriteUnlock(shard);
+    if (status == HOTEL_OK && !persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        status = HOTEL_ERR_IO;
+    }
+    metricsRecord(METRIC_BOOK, start);
+
+    replyStatus(reply, status);
+}
+
+void handleModify(Session* session, int roomNumber, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute, char reply[]) {
+    HotelRWLock* shard = &roomShards[shardOf(roomNumber)];
+    HotelStatus status = HOTEL_ERR_NOT_FOUND;
+
+    hotelWriteLock(shard);
+    hotelMutexLock(&engineMutex);
+    Reservation* reservation = findUserReservation(session->username, roomNumber);
+    if (reservation != NULL) {
+        status = hotelModify(reservation, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+    }
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    hotelWriteUnlock(shard);
+    if (status == HOTEL_OK && !persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        status = HOTEL_ERR_IO;
+    }
+
+    replyStatus(reply, status);
+}
+
+void handleCancel(Session* session, int roomNumber, char reply[]) {
+    HotelRWLock* shard = &roomShards[shardOf(roomNumber)];
+
+    hotelWriteLock(shard);
+    hotelMutexLock(&engineMutex);
+    HotelStatus status = hotelCancel(session->username, roomNumber);
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    hotelWriteUnlock(shard);
+    if (status == HOTEL_OK && !persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        status = HOTEL_ERR_IO;
+    }
+
+    replyStatus(reply, status);
+}
+
+// Room-type entries may land in any shard, so a group holds all of them
+void handleGroup(Session* session, int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute,
+                 char* targets[], int count, char reply[]) {
+    GroupBooking bookings[MAX_ARGS];
+    int failedIndex, i;
+    int length;
+
+    for (i = 0; i < count; i++) {
+        bookings[i].roomNumber = isdigit((unsigned char)targets[i][0]) ? atoi(targets[i]) : 0;
+        snprintf(bookings[i].roomType, sizeof(bookings[i].roomType), "%s", targets[i]);
+        bookings[i].checkInDay = checkInDay;
+        bookings[i].checkInMinute = checkInMinute;
+        bookings[i].checkOutDay = checkOutDay;
+        bookings[i].checkOutMinute = checkOutMinute;
+    }
+
+    lockAllShards(1);
+    hotelMutexLock(&engineMutex);
+    HotelStatus status = hotelBookGroup(session->username, bookings, count, &failedIndex);
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    unlockAllShards(1);
+
+    if (status != HOTEL_OK && failedIndex >= 0) {
+        snprintf(reply, MAX_REPLY_LEN, "ERR %s: %s", targets[failedIndex], hotelStatusMessage(status));
+        return;
+    }
+    if (status != HOTEL_OK) {
+        replyStatus(reply, status);
+        return;
+    }
+    if (!persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        replyStatus(reply, HOTEL_ERR_IO);
+        return;
+    }
+    length = snprintf(reply, MAX_REPLY_LEN, "OK");
+    for (i = 0; i < count; i++) {
+        length += snprintf(reply + length, MAX_REPLY_LEN - length, " %d", bookings[i].roomNumber);
+    }
+}
+
+// Searches only read room indexes, so they share the shards with each other
+void handleSearch(char roomType[], int checkInDay, int checkOutDay, char reply[]) {
+    int roomNumbers[MAX_SEARCH_RESULTS];
+    int found, i;
+    int length;
+
+    lockAllShards(0);
+    found = searchRooms(roomType, checkInDay, checkOutDay, roomNumbers, MAX_SEARCH_RESULTS);
+    unlockAllShards(0);
+
+    length = snprintf(reply, MAX_REPLY_LEN, "OK %d", found);
+    for (i = 0; i < found && length < MAX_REPLY_LEN - 12; i++) {
+        length += snprintf(reply + length, MAX_REPLY_LEN - length, " %d", roomNumbers[i]);
+    }
+}
+
+// Like a search, a room or every room of a type, read under shared shards
+void handleEarliest(char target[], int fromDay, int nights, char reply[]) {
+    int roomNumber = isdigit((unsigned char)target[0]) ? atoi(target) : 0;
+    int checkInDay;
+    char date[11];
+
+    if (nights < 1 || nights > OCCUPANCY_DAYS) {
+        replyStatus(reply, HOTEL_ERR_INVALID_DATES);
+        return;
+    }
+
+    lockAllShards(0);
+    roomNumber = findEarliestSlot(target, roomNumber, fromDay, nights, &checkInDay);
+    unlockAllShards(0);
+
+    if (roomNumber == 0) {
+        replyStatus(reply, HOTEL_ERR_INVALID_ROOM);
+        return;
+    }
+    dayToDate(checkInDay, date);
+    snprintf(reply, MAX_REPLY_LEN, "OK %s %d", date, roomNumber);
+}
+
+// The best fitting room may be in any shard, so like a group this holds all of them
+void handleBestFit(Session* session, char roomType[], int checkInDay, int checkInMinute, int checkOutDay, int checkOutMinute,
+                   char reply[]) {
+    int roomNumber;
+
+    lockAllShards(1);
+    hotelMutexLock(&engineMutex);
+    HotelStatus status = hotelBookBestFit(session->username, roomType, checkInDay, checkInMinute,
+                                          checkOutDay, checkOutMinute, &roomNumber);
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    unlockAllShards(1);
+
+    if (status != HOTEL_OK) {
+        replyStatus(reply, status);
+        return;
+    }
+    if (!persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        replyStatus(reply, HOTEL_ERR_IO);
+        return;
+    }
+    snprintf(reply, MAX_REPLY_LEN, "OK %d", roomNumber);
+}
+
+// Moves bookings that have not checked in yet as of now, across every room of their type
+void handleReoptimize(char roomType[], char reply[]) {
+    ReoptimizeResult result;
+    int today, minute;
+
+    getCurrentDateTime(&today, &minute);
+    lockAllShards(1);
+    hotelMutexLock(&engineMutex);
+    HotelStatus status = hotelReoptimize(roomType, today, minute, &result);
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    unlockAllShards(1);
+
+    if (status != HOTEL_OK) {
+        replyStatus(reply, status);
+        return;
+    }
+    if (result.moved > 0 && !persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        replyStatus(reply, HOTEL_ERR_IO);
+        return;
+    }
+    snprintf(reply, MAX_REPLY_LEN, "OK %d %d %d", result.moved, result.orphanDaysBefore, result.orphanDaysAfter);
+}
+
+// Every room of the type is repriced, so searches are kept out of all shards
+void handleRate(char roomType[], double pricePerNight, char reply[]) {
+    lockAllShards(1);
+    hotelMutexLock(&engineMutex);
+    HotelStatus status = hotelSetRoomRate(roomType, pricePerNight);
+    unsigned long long sequence = journalSequence;
+    hotelMutexUnlock(&engineMutex);
+    unlockAllShards(1);
+    if (status == HOTEL_OK && !persistMutation(sequence, persistMode == PERSIST_STRICT)) {
+        status = HOTEL_ERR_IO;
+    }
+
+    replyStatus(reply, status);
+}
@@ -0,0 +1,106 @@
+#ifndef HOTEL_THREADS_H
+#define HOTEL_THREADS_H
+
+// Minimal threads, locks and sockets over pthreads/BSD sockets or Win32/Winsock
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+typedef CRITICAL_SECTION HotelMutex;
+typedef CONDITION_VARIABLE HotelCond;
+typedef SRWLOCK HotelRWLock;
+typedef SOCKET HotelSocket;
+#define HOTEL_INVALID_SOCKET INVALID_SOCKET
+#define HOTEL_THREAD_FUNC(name, arg) DWORD WINAPI name(LPVOID arg)
+#define HOTEL_THREAD_RETURN return 0
+
+static void hotelMutexInit(HotelMutex* mutex) { InitializeCriticalSection(mutex); }
+static void hotelMutexLock(HotelMutex* mutex) { EnterCriticalSection(mutex); }
+static void hotelMutexUnlock(HotelMutex* mutex) { LeaveCriticalSection(mutex); }
+
+static void hotelCondInit(HotelCond* cond) { InitializeConditionVariable(cond); }
+static void hotelCondWait(HotelCond* cond, HotelMutex* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+static void hotelCondSignal(HotelCond* cond) { WakeConditionVariable(cond); }
+static void hotelCondBroadcast(HotelCond* cond) { WakeAllConditionVariable(cond); }
+
+static void hotelRWLockInit(HotelRWLock* lock) { InitializeSRWLock(lock); }
+static void hotelReadLock(HotelRWLock* lock) { AcquireSRWLockShared(lock); }
+static void hotelReadUnlock(HotelRWLock* lock) { ReleaseSRWLockShared(lock); }
+static void hotelWriteLock(HotelRWLock* lock) { AcquireSRWLockExclusive(lock); }
+static void hotelWriteUnlock(HotelRWLock* lock) { ReleaseSRWLockExclusive(lock); }
+
+// Start a detached thread. Returns 0 on failure.
+static int hotelThreadStart(LPTHREAD_START_ROUTINE function, void* arg) {
+    HANDLE thread = CreateThread(NULL, 0, function, arg, 0, NULL);
+    if (thread == NULL) {
+        return 0;
+    }
+    CloseHandle(thread);
+    return 1;
+}
+
+static void hotelSleepSeconds(int seconds) { Sleep(seconds * 1000); }
+static void hotelSleepMillis(int millis) { Sleep(millis); }
+
+static int hotelSocketStartup() {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+}
+static void hotelCloseSocket(HotelSocket socket) { closesocket(socket); }
+
+#else
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+typedef pthread_mutex_t HotelMutex;
+typedef pthread_cond_t HotelCond;
+typedef pthread_rwlock_t HotelRWLock;
+typedef int HotelSocket;
+#define HOTEL_INVALID_SOCKET (-1)
+#define HOTEL_THREAD_FUNC(name, arg) void* name(void* arg)
+#define HOTEL_THREAD_RETURN return NULL
+
+static void hotelMutexInit(HotelMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static void hotelMutexLock(HotelMutex* mutex) { pthread_mutex_lock(mutex); }
+static void hotelMutexUnlock(HotelMutex* mutex) { pthread_mutex_unlock(mutex); }
+
+static void hotelCondInit(HotelCond* cond) { pthread_cond_init(cond, NULL); }
+static void hotelCondWait(HotelCond* cond, HotelMutex* mutex) { pthread_cond_wait(cond, mutex); }
+static void hotelCondSignal(HotelCond* cond) { pthread_cond_signal(cond); }
+static void hotelCondBroadcast(HotelCond* cond) { pthread_cond_broadcast(cond); }
+
+static void hotelRWLockInit(HotelRWLock* lock) { pthread_rwlock_init(lock, NULL); }
+static void hotelReadLock(HotelRWLock* lock) { pthread_rwlock_rdlock(lock); }
+static void hotelReadUnlock(HotelRWLock* lock) { pthread_rwlock_unlock(lock); }
+static void hotelWriteLock(HotelRWLock* lock) { pthread_rwlock_wrlock(lock); }
+static void hotelWriteUnlock(HotelRWLock* lock) { pthread_rwlock_unlock(lock); }
+
+// Start a detached thread. Returns 0 on failure.
+static int hotelThreadStart(void* (*function)(void*), void* arg) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, function, arg) != 0) {
+        return 0;
+    }
+    pthread_detach(thread);
+    return 1;
+}
+
+static void hotelSleepSeconds(int seconds) { sleep(seconds); }
+static void hotelSleepMillis(int millis) { usleep(millis * 1000); }
+
+// A client hanging up mid-reply must not kill the server with SIGPIPE
+static int hotelSocketStartup() {
+    signal(SIGPIPE, SIG_IGN);
+    return 1;
+}
+static void hotelCloseSocket(HotelSocket socket) { close(socket); }
+
+#endif
+
+#endif
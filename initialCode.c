@@ -1,14 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <conio.h>
-#include <time.h>
 #include <string.h>
 #include <windows.h>
 
-#define MAX_NAME_LEN 50
-#define MAX_PASSWORD_LEN 50
-#define MAX_ROOM_TYPE_LEN 50
-#define DATA_FILE "reservations.dat"
+#include "hotelEngine.h"
+#include "hotelArchive.h"
+#include "hotelAssign.h"
+#include "hotelMetrics.h"
+#include "hotelReport.h"
 
 // Key codes
 #define KEY_UP 72
@@ -16,6 +16,8 @@
 #define KEY_ENTER 13
 #define KEY_ESC 27
 
+#define REPORT_MONTHS 6 // Months of archive history on the statistics screen
+
 // Colors
 #ifndef COLOR_NORMAL
 #define COLOR_NORMAL 7     // White text on black background
@@ -25,73 +27,39 @@
 #define COLOR_HIGHLIGHT 240 // Black text on white background
 #endif
 
-typedef struct Room {
-    int roomNumber;
-    char roomType[MAX_ROOM_TYPE_LEN];
-    double pricePerNight;
-} Room;
-
-typedef struct Reservation {
-    char username[MAX_NAME_LEN];
-    int roomNumber;
-    char checkInDate[11];
-    char checkInTime[6];
-    char checkOutDate[11];
-    char checkOutTime[6];
-    struct Reservation* next;
-} Reservation;
-
-typedef struct User {
-    char username[MAX_NAME_LEN];
-    char password[MAX_PASSWORD_LEN];
-    int isAdmin;
-    struct User* next;
-} User;
-
-User* userList = NULL;
-Reservation* reservationList = NULL;
-Room* rooms = NULL;
-int totalRooms = 0;
-int maxRooms = 0;
-
 // Function prototypes
-void addUser(char username[], char password[], int isAdmin);
-User* authenticateUser(char username[], char password[]);
 void displayRooms();
 void makeReservation(char username[]);
 void viewReservations(char username[]);
-void addReservation(char username[], int roomNumber, char checkInDate[], char checkInTime[], char checkOutDate[], char checkOutTime[]);
 void removeReservation(char username[]);
 void showAdminMenu();
 void showUserMenu(char username[]);
-void cleanup();
 void registerUser();
-void initializeRooms();
 void createRoom();
 void viewReservationsByRoom();
-void resizeRooms();
-void saveData();
-void loadData();
-void checkExpiredReservations();
-int isValidDate(char date[]);
-int isValidTime(char time[]);
-int isLeapYear(int year);
 void changePassword(char username[]);
 void modifyReservation(char username[]);
 void deleteUser();
 void viewAllReservations();
 void viewStatistics();
+void viewMetrics();
 void searchAvailableRooms();
-int compareDates(char date1[], char date2[]);
+void reoptimizeRooms();
 void displayHeader(const char* title);
-int isRoomBooked(int roomNumber);
-void updateRoomPrices(void);
-int isRoomAvailableForDates(int roomNumber, char checkInDate[], char checkOutDate[]);
-char* formatDateTime(char date[], char time[]);
 int getMenuChoice(char* menuItems[], int itemCount);
 void gotoxy(int x, int y);
 void setTextColor(int color);
 void displayMessage(const char* message);
+void startBackgroundSnapshot();
+void waitForSnapshot();
+void checkSnapshot();
+DWORD WINAPI snapshotWriter(LPVOID arg);
+
+// Checkpoint written by snapshotWriter while the menus keep running
+SnapshotImage pendingSnapshot;
+volatile LONG snapshotWriting = 0;
+volatile LONG snapshotFailed = 0;
+unsigned long long snapshotWrittenSequence = 0; // Set by snapshotWriter before it clears snapshotWriting
 
 // Function to position cursor at specific coordinates
 void gotoxy(int x, int y) {
@@ -105,6 +73,57 @@ void gotoxy(int x, int y) {
 void setTextColor(int color) {
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), color);
 }
+
+// Copy the data into memory here and let another thread write the snapshot
+// file, so logging out or a busy journal never waits on the disk
+void startBackgroundSnapshot() {
+    waitForSnapshot();
+    if (!captureSnapshot(&pendingSnapshot)) {
+        InterlockedExchange(&snapshotFailed, 1);
+        return;
+    }
+    
+    InterlockedExchange(&snapshotWriting, 1);
+    HANDLE thread = CreateThread(NULL, 0, snapshotWriter, &pendingSnapshot, 0, NULL);
+    if (thread == NULL) {
+        snapshotWriter(&pendingSnapshot);
+    } else {
+        CloseHandle(thread);
+    }
+}
+
+DWORD WINAPI snapshotWriter(LPVOID arg) {
+    unsigned long long sequence = ((SnapshotImage*)arg)->sequence;
+    
+    if (writeSnapshot((SnapshotImage*)arg)) {
+        snapshotWrittenSequence = sequence;
+    } else {
+        InterlockedExchange(&snapshotFailed, 1);
+    }
+    InterlockedExchange(&snapshotWriting, 0);
+    return 0;
+}
+
+// Only one checkpoint may be on its way to disk at a time
+void waitForSnapshot() {
+    while (snapshotWriting) {
+        Sleep(10);
+    }
+}
+
+// Start a checkpoint once the journal has grown enough, and report one that failed
+void checkSnapshot() {
+    if (InterlockedExchange(&snapshotFailed, 0)) {
+        displayMessage("Error: Could not write the snapshot file.");
+    }
+    if (!snapshotWriting) {
+        markSnapshotDurable(snapshotWrittenSequence);
+    }
+    if (!snapshotWriting && snapshotDue()) {
+        startBackgroundSnapshot();
+    }
+}
+
 // Function to get menu choice using highlighting
 int getMenuChoice(char* menuItems[], int itemCount) {
     int selected = 0;
@@ -190,131 +209,12 @@ void displayHeader(const char* title) {
 void displayMessage(const char* message) {
     printf("\n  %s\n", message);
     printf("\n  Press any key to continue...");
-    getch();
-}
-
-int isLeapYear(int year) {
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-}
-
-int isValidDate(char date[]) {
-    // Check format YYYY-MM-DD
-    if (strlen(date) != 10 || date[4] != '-' || date[7] != '-') {
-        return 0;
-    }
-    
-    int year, month, day;
-    sscanf(date, "%d-%d-%d", &year, &month, &day);
-    
-    if (month < 1 || month > 12) return 0;
-    if (day < 1 || day > 31) return 0;
-    
-    // Check days in month
-    if (month == 2) {
-        if (isLeapYear(year)) {
-            if (day > 29) return 0;
-        } else {
-            if (day > 28) return 0;
-        }
-    } else if (month == 4 || month == 6 || month == 9 || month == 11) {
-        if (day > 30) return 0;
-    }
     
-    return 1;
-}
-
-int isValidTime(char time[]) {
-    // Check format HH:MM
-    if (strlen(time) != 5 || time[2] != ':') {
-        return 0;
-    }
-    
-    int hour, minute;
-    sscanf(time, "%d:%d", &hour, &minute);
-    
-    if (hour < 0 || hour > 23) return 0;
-    if (minute < 0 || minute > 59) return 0;
-    
-    return 1;
-}
-
-// Check if a room is currently booked for any date
-int isRoomBooked(int roomNumber) {
-    Reservation* current = reservationList;
-    while (current != NULL) {
-        if (current->roomNumber == roomNumber) {
-            return 1; // Room is booked
-        }
-        current = current->next;
-    }
-    return 0; // Room is not booked
-}
-
-// Check if a room is available for specific dates
-int isRoomAvailableForDates(int roomNumber, char checkInDate[], char checkOutDate[]) {
-    Reservation* current = reservationList;
-    
-    while (current != NULL) {
-        if (current->roomNumber == roomNumber) {
-            
-            if (!(compareDates(checkOutDate, current->checkInDate) < 0 || 
-                  compareDates(checkInDate, current->checkOutDate) > 0)) {
-                return 0; 
-            }
-        }
-        current = current->next;
+    // The confirmation is already on screen; write the journal while it is read
+    if (!flushJournal()) {
+        printf("\n  Warning: the change could not be written to disk.");
     }
-    
-    return 1; 
-}
-
-void initializeRooms() {
-    maxRooms = 10;
-    rooms = (Room*)malloc(maxRooms * sizeof(Room));
-    int i;
-    for (i = 0; i < maxRooms; i++) {
-        rooms[i].roomNumber = i + 1;
-        
-        // Assign different room types and prices
-        if (i < 4) {
-            strcpy(rooms[i].roomType, "Standard");
-            rooms[i].pricePerNight = 1500.0;
-        } else if (i < 7) {
-            strcpy(rooms[i].roomType, "Deluxe");
-            rooms[i].pricePerNight = 2000.0;
-        } else {
-            strcpy(rooms[i].roomType, "Suite");
-            rooms[i].pricePerNight = 3000.0;
-        }
-    }
-    totalRooms = maxRooms;
-}
-
-void addUser(char username[], char password[], int isAdmin) {
-    User* current = userList;
-    while (current != NULL) {
-        if (strcmp(current->username, username) == 0) {
-            return; 
-        }
-        current = current->next;
-    }
-    User* newUser = (User*)malloc(sizeof(User));
-    strcpy(newUser->username, username);
-    strcpy(newUser->password, password);
-    newUser->isAdmin = isAdmin;
-    newUser->next = userList;
-    userList = newUser;
-}
-
-User* authenticateUser(char username[], char password[]) {
-    User* current = userList;
-    while (current != NULL) {
-        if (strcmp(current->username, username) == 0 && strcmp(current->password, password) == 0) {
-            return current; 
-        }
-        current = current->next;
-    }
-    return NULL; 
+    getch();
 }
 
 void displayRooms() {
@@ -327,9 +227,9 @@ void displayRooms() {
     for (i = 0; i < totalRooms; i++) {
         printf("  %-8d %-20s %-12s P%-14.0f\n", 
                rooms[i].roomNumber, 
-               rooms[i].roomType, 
+               roomTypes[rooms[i].typeId].name, 
                "Available", // Always show as available
-               rooms[i].pricePerNight);
+               roomTypes[rooms[i].typeId].pricePerNight);
     }
     
     printf("  ----------------------------------------------------------\n");
@@ -339,14 +239,24 @@ void makeReservation(char username[]) {
     displayHeader("MAKE A RESERVATION");
     
     int roomNumber;
+    char roomType[MAX_ROOM_TYPE_LEN] = "";
     char checkInDate[11], checkInTime[6], checkOutDate[11], checkOutTime[6];
     
     displayRooms();
     
-    printf("\n  Enter room number to reserve: ");
+    printf("\n  Enter room number to reserve (0 to have one assigned): ");
     scanf("%d", &roomNumber);
     
-    if (roomNumber < 1 || roomNumber > totalRooms) {
+    // With no room named, the hotel picks the room of the type that fits the stay best
+    if (roomNumber == 0) {
+        printf("  Enter room type: ");
+        scanf("%49s", roomType);
+        
+        if (findRoomType(roomType) < 0) {
+            displayMessage("Error: Invalid room type.");
+            return;
+        }
+    } else if (findRoom(roomNumber) == NULL) {
         displayMessage("Error: Invalid room number.");
         return;
     }
@@ -383,44 +293,50 @@ void makeReservation(char username[]) {
         return;
     }
     
+    int checkInDay = dateToDay(checkInDate);
+    int checkInMinute = timeToMinute(checkInTime);
+    int checkOutDay = dateToDay(checkOutDate);
+    int checkOutMinute = timeToMinute(checkOutTime);
+    
+    HotelStatus status;
+    if (roomNumber == 0) {
+        status = hotelBookBestFit(username, roomType, checkInDay, checkInMinute, checkOutDay, checkOutMinute, &roomNumber);
+    } else {
+        status = hotelBook(username, roomNumber, checkInDay, checkInMinute, checkOutDay, checkOutMinute);
+    }
+    
     // Validate check-in before check-out
-    if (compareDates(checkInDate, checkOutDate) > 0 || 
-        (compareDates(checkInDate, checkOutDate) == 0 && strcmp(checkInTime, checkOutTime) >= 0)) {
+    if (status == HOTEL_ERR_INVALID_DATES) {
         displayMessage("Error: Check-in date/time must be before check-out date/time.");
         return;
     }
     
-    // Check if room is available for the selected dates
-    if (!isRoomAvailableForDates(roomNumber, checkInDate, checkOutDate)) {
-        char message[100];
-        sprintf(message, "Error: Room %d is not available for the selected dates.\nPlease select different dates or a different room.", roomNumber);
+    // Check if room is available for the selected dates, and if not, when the same stay would fit
+    if (status == HOTEL_ERR_ROOM_UNAVAILABLE) {
+        char message[200];
+        char earliestDate[11];
+        int earliestDay;
+        int earliestRoom = findEarliestSlot(roomType, roomNumber, checkInDay, checkOutDay - checkInDay, &earliestDay);
+        
+        if (roomNumber == 0) {
+            sprintf(message, "Error: No room of that type is available for the selected dates.");
+        } else {
+            sprintf(message, "Error: Room %d is not available for the selected dates.", roomNumber);
+        }
+        if (earliestRoom != 0) {
+            dayToDate(earliestDay, earliestDate);
+            sprintf(message + strlen(message), "\nThe earliest check-in for the same stay is %s (room %d).", earliestDate, earliestRoom);
+        }
         displayMessage(message);
         return;
     }
     
-    addReservation(username, roomNumber, checkInDate, checkInTime, checkOutDate, checkOutTime);
-    
-    // Save data immediately after making a reservation
-    saveData();
-    
     char message[100];
     sprintf(message, "Reservation Successful\nRoom %d has been reserved for you.", roomNumber);
     displayHeader("RESERVATION SUCCESSFUL");
     displayMessage(message);
 }
 
-void addReservation(char username[], int roomNumber, char checkInDate[], char checkInTime[], char checkOutDate[], char checkOutTime[]) {
-    Reservation* newReservation = (Reservation*)malloc(sizeof(Reservation));
-    strcpy(newReservation->username, username);
-    newReservation->roomNumber = roomNumber;
-    strcpy(newReservation->checkInDate, checkInDate);
-    strcpy(newReservation->checkInTime, checkInTime);
-    strcpy(newReservation->checkOutDate, checkOutDate);
-    strcpy(newReservation->checkOutTime, checkOutTime);
-    newReservation->next = reservationList;
-    reservationList = newReservation;
-}
-
 void removeReservation(char username[]) {
     displayHeader("REMOVE RESERVATION");
     
@@ -430,8 +346,7 @@ void removeReservation(char username[]) {
     printf("  Enter username to remove reservation: ");
     scanf("%s", inputUsername);
     
-    Reservation* current = reservationList;
-    Reservation* prev = NULL;
+    Reservation* current = getUserReservations(inputUsername);
     int found = 0;
     
     // Display user's reservations
@@ -440,14 +355,12 @@ void removeReservation(char username[]) {
     printf("  ------------------------------------------------------------------\n");
     
     while (current != NULL) {
-        if (strcmp(current->username, inputUsername) == 0) {
-            printf("  %-8d %-25s %-25s\n", 
-                   current->roomNumber, 
-                   formatDateTime(current->checkInDate, current->checkInTime),
-                   formatDateTime(current->checkOutDate, current->checkOutTime));
-            found = 1;
-        }
-        current = current->next;
+        printf("  %-8d %-25s %-25s\n", 
+               current->roomNumber, 
+               formatDateTime(current->checkInDay, current->checkInMinute),
+               formatDateTime(current->checkOutDay, current->checkOutMinute));
+        found = 1;
+        current = current->userNext;
     }
     
     if (!found) {
@@ -460,63 +373,38 @@ void removeReservation(char username[]) {
     printf("\n  Enter room number to remove reservation: ");
     scanf("%d", &roomNumber);
     
-    if (roomNumber < 1 || roomNumber > totalRooms) {
+    if (findRoom(roomNumber) == NULL) {
         displayMessage("Error: Invalid room number.");
         return;
     }
     
-    current = reservationList;
-    prev = NULL;
-    found = 0;
-    
-    while (current != NULL) {
-        if (strcmp(current->username, inputUsername) == 0 && current->roomNumber == roomNumber) {
-            found = 1;
-            
-            if (prev == NULL) {
-                reservationList = current->next;
-            } else {
-                prev->next = current->next;
-            }
-            
-            free(current);
-            
-            // Save data immediately after removing a reservation
-            saveData();
-            
-            char message[100];
-            sprintf(message, "Reservation for Room %d by %s has been removed successfully.", roomNumber, inputUsername);
-            displayHeader("RESERVATION REMOVED");
-            displayMessage(message);
-            return;
-        }
-        prev = current;
-        current = current->next;
-    }
-    
-    if (!found) {
+    if (hotelCancel(inputUsername, roomNumber) != HOTEL_OK) {
         displayMessage("No reservation found for this room and user.");
+        return;
     }
+    
+    char message[150];
+    sprintf(message, "Reservation for Room %d by %s has been removed successfully.", roomNumber, inputUsername);
+    displayHeader("RESERVATION REMOVED");
+    displayMessage(message);
 }
 
 void viewReservations(char username[]) {
     displayHeader("YOUR RESERVATIONS");
     
-    Reservation* current = reservationList;
+    Reservation* current = getUserReservations(username);
     int found = 0;
     
     printf("  %-8s %-25s %-25s\n", "Room #", "Check-in", "Check-out");
     printf("  ------------------------------------------------------------------\n");
     
     while (current != NULL) {
-        if (strcmp(current->username, username) == 0) {
-            printf("  %-8d %-25s %-25s\n", 
-                   current->roomNumber, 
-                   formatDateTime(current->checkInDate, current->checkInTime),
-                   formatDateTime(current->checkOutDate, current->checkOutTime));
-            found = 1;
-        }
-        current = current->next;
+        printf("  %-8d %-25s %-25s\n", 
+               current->roomNumber, 
+               formatDateTime(current->checkInDay, current->checkInMinute),
+               formatDateTime(current->checkOutDay, current->checkOutMinute));
+        found = 1;
+        current = current->userNext;
     }
     
     if (!found) {
@@ -531,44 +419,41 @@ void viewReservations(char username[]) {
 void createRoom() {
     displayHeader("CREATE NEW ROOM");
     
-    resizeRooms();
-    int roomNumber = totalRooms + 1;
+    char roomRange[24];
     char roomType[MAX_ROOM_TYPE_LEN];
     double pricePerNight;
+    int firstRoom, lastRoom;
     
-    printf("  Enter room type for Room %d: ", roomNumber);
-    scanf("%s", roomType);
+    printf("  Enter room number, or a range such as 1201-1230: ");
+    scanf("%23s", roomRange);
     
-    printf("  Enter price per night for Room %d: $", roomNumber);
-    scanf("%lf", &pricePerNight);
+    int fields = sscanf(roomRange, "%d-%d", &firstRoom, &lastRoom);
+    if (fields == 1) {
+        lastRoom = firstRoom;
+    }
+    if (fields < 1 || firstRoom < 1 || lastRoom < firstRoom || lastRoom - firstRoom >= MAX_ROOM_RANGE) {
+        displayMessage("Error: Invalid room number.");
+        return;
+    }
     
-    rooms[totalRooms].roomNumber = roomNumber;
-    strcpy(rooms[totalRooms].roomType, roomType);
-    rooms[totalRooms].pricePerNight = pricePerNight;
-    totalRooms++;
+    printf("  Enter room type: ");
+    scanf("%s", roomType);
     
-    // Save data immediately after creating a room
-    saveData();
+    printf("  Enter price per night (used if the type is new): $");
+    scanf("%lf", &pricePerNight);
     
     char message[100];
-    sprintf(message, "Room %d created successfully!", roomNumber);
+    if (firstRoom == lastRoom) {
+        hotelCreateRoom(firstRoom, roomType, pricePerNight);
+        sprintf(message, "Room %d created successfully!", firstRoom);
+    } else {
+        hotelCreateRoomRange(firstRoom, lastRoom, roomType, pricePerNight);
+        sprintf(message, "Rooms %d-%d created successfully!", firstRoom, lastRoom);
+    }
     displayHeader("ROOM CREATED");
     displayMessage(message);
 }
 
-void resizeRooms() {
-    if (totalRooms >= maxRooms) {
-        maxRooms *= 2;
-        rooms = (Room*)realloc(rooms, maxRooms * sizeof(Room));
-        int i;
-        for (i = totalRooms; i < maxRooms; i++) {
-            rooms[i].roomNumber = i + 1;
-            strcpy(rooms[i].roomType, "Standard");
-            rooms[i].pricePerNight = 1500.0;
-        }
-    }
-}
-
 void viewReservationsByRoom() {
     displayHeader("ROOM RESERVATIONS");
     
@@ -577,30 +462,28 @@ void viewReservationsByRoom() {
     printf("  Enter room number to view reservations: ");
     scanf("%d", &roomNumber);
     
-    if (roomNumber < 1 || roomNumber > totalRooms) {
+    if (findRoom(roomNumber) == NULL) {
         displayMessage("Error: Invalid room number.");
         return;
     }
     
-    Reservation* current = reservationList;
-    int found = 0;
+    RoomBookings* bookings = getRoomBookings(roomNumber, 0);
+    int i;
     
     printf("\n  Reservations for Room %d:\n", roomNumber);
     printf("  %-10s %-25s %-25s\n", "Username", "Check-in", "Check-out");
     printf("  ------------------------------------------------------------------\n");
     
-    while (current != NULL) {
-        if (current->roomNumber == roomNumber) {
-            printf("  %-10s %-25s %-25s\n", 
-                   current->username, 
-                   formatDateTime(current->checkInDate, current->checkInTime),
-                   formatDateTime(current->checkOutDate, current->checkOutTime));
-            found = 1;
-        }
-        current = current->next;
+    // The room index is already in check-in order
+    for (i = 0; i < bookings->count; i++) {
+        Reservation* current = bookings->items[i];
+        printf("  %-10s %-25s %-25s\n", 
+               current->username, 
+               formatDateTime(current->checkInDay, current->checkInMinute),
+               formatDateTime(current->checkOutDay, current->checkOutMinute));
     }
     
-    if (!found) {
+    if (bookings->count == 0) {
         char message[100];
         sprintf(message, "No reservations found for Room %d.", roomNumber);
         printf("  %s\n", message);
@@ -653,19 +536,17 @@ void changePassword(char username[]) {
     }
     newPassword[i] = '\0';
     
-    strcpy(user->password, newPassword);
-    
-    // Save data immediately after changing password
-    saveData();
+    hotelChangePassword(username, newPassword);
     
     displayHeader("PASSWORD CHANGED");
     displayMessage("Your password has been changed successfully!");
 }
+
 void modifyReservation(char username[]) {
     displayHeader("MODIFY RESERVATION");
     
     // Display user's reservations first
-    Reservation* current = reservationList;
+    Reservation* current = getUserReservations(username);
     int found = 0;
     
     printf("  Your Current Reservations:\n");
@@ -673,14 +554,12 @@ void modifyReservation(char username[]) {
     printf("  ------------------------------------------------------------------\n");
     
     while (current != NULL) {
-        if (strcmp(current->username, username) == 0) {
-            printf("  %-8d %-25s %-25s\n", 
-                   current->roomNumber, 
-                   formatDateTime(current->checkInDate, current->checkInTime),
-                   formatDateTime(current->checkOutDate, current->checkOutTime));
-            found = 1;
-        }
-        current = current->next;
+        printf("  %-8d %-25s %-25s\n", 
+               current->roomNumber, 
+               formatDateTime(current->checkInDay, current->checkInMinute),
+               formatDateTime(current->checkOutDay, current->checkOutMinute));
+        found = 1;
+        current = current->userNext;
     }
     
     if (!found) {
@@ -692,18 +571,9 @@ void modifyReservation(char username[]) {
     printf("\n  Enter room number to modify reservation: ");
     scanf("%d", &roomNumber);
     
-    current = reservationList;
-    found = 0;
-    
-    while (current != NULL) {
-        if (strcmp(current->username, username) == 0 && current->roomNumber == roomNumber) {
-            found = 1;
-            break;
-        }
-        current = current->next;
-    }
+    current = findUserReservation(username, roomNumber);
     
-    if (!found) {
+    if (current == NULL) {
         char message[100];
         sprintf(message, "Error: No reservation found for Room %d.", roomNumber);
         displayMessage(message);
@@ -711,8 +581,8 @@ void modifyReservation(char username[]) {
     }
     
     // Display current reservation details
-    printf("\n  Current Check-in Date: %s, Check-in Time: %s\n", current->checkInDate, current->checkInTime);
-    printf("  Current Check-out Date: %s, Check-out Time: %s\n", current->checkOutDate, current->checkOutTime);
+    printf("\n  Current Check-in: %s\n", formatDateTime(current->checkInDay, current->checkInMinute));
+    printf("  Current Check-out: %s\n", formatDateTime(current->checkOutDay, current->checkOutMinute));
     
     // Instead of using getMenuChoice, directly display the options and get input
     printf("\n  What would you like to modify?\n");
@@ -725,6 +595,8 @@ void modifyReservation(char username[]) {
     scanf("%d", &choice);
     
     char newDate[11], newTime[6];
+    int newDay, newMinute;
+    HotelStatus status;
     
     switch (choice) {
         case 1: // Modify check-in
@@ -744,20 +616,21 @@ void modifyReservation(char username[]) {
                 return;
             }
             
+            newDay = dateToDay(newDate);
+            newMinute = timeToMinute(newTime);
+            
+            status = hotelModify(current, newDay, newMinute, current->checkOutDay, current->checkOutMinute);
+            
             // Validate that new check-in date/time is before check-out date/time
-            if (compareDates(newDate, current->checkOutDate) > 0 || 
-                (compareDates(newDate, current->checkOutDate) == 0 && 
-                 strcmp(newTime, current->checkOutTime) >= 0)) {
+            if (status == HOTEL_ERR_INVALID_DATES) {
                 displayMessage("Error: Check-in date/time must be before check-out date/time.");
                 return;
             }
             
-            // If validation passes, update the reservation
-            strcpy(current->checkInDate, newDate);
-            strcpy(current->checkInTime, newTime);
-            
-            // Save data immediately after modifying a reservation
-            saveData();
+            if (status == HOTEL_ERR_ROOM_UNAVAILABLE) {
+                displayMessage("Error: Room is already booked for the new dates.");
+                return;
+            }
             
             char message1[100];
             sprintf(message1, "Your check-in has been updated to %s at %s", newDate, newTime);
@@ -782,20 +655,21 @@ void modifyReservation(char username[]) {
                 return;
             }
             
+            newDay = dateToDay(newDate);
+            newMinute = timeToMinute(newTime);
+            
+            status = hotelModify(current, current->checkInDay, current->checkInMinute, newDay, newMinute);
+            
             // Validate that check-in date/time is before new check-out date/time
-            if (compareDates(current->checkInDate, newDate) > 0 || 
-                (compareDates(current->checkInDate, newDate) == 0 && 
-                 strcmp(current->checkInTime, newTime) >= 0)) {
+            if (status == HOTEL_ERR_INVALID_DATES) {
                 displayMessage("Error: Check-out date/time must be after check-in date/time.");
                 return;
             }
             
-            // If validation passes, update the reservation
-            strcpy(current->checkOutDate, newDate);
-            strcpy(current->checkOutTime, newTime);
-            
-            // Save data immediately after modifying a reservation
-            saveData();
+            if (status == HOTEL_ERR_ROOM_UNAVAILABLE) {
+                displayMessage("Error: Room is already booked for the new dates.");
+                return;
+            }
             
             char message2[100];
             sprintf(message2, "Your check-out has been updated to %s at %s", newDate, newTime);
@@ -834,120 +708,162 @@ void deleteUser() {
     printf("\n  Enter username to delete: ");
     scanf("%s", username);
     
+    HotelStatus status = hotelDeleteUser(username);
+    
     // Don't allow deleting the admin account
-    if (strcmp(username, "admin") == 0) {
+    if (status == HOTEL_ERR_PROTECTED_USER) {
         displayMessage("Error: Cannot delete the main admin account.");
         return;
     }
     
-    User* current = userList;
-    User* prev = NULL;
-    int found = 0;
-    
-    while (current != NULL) {
-        if (strcmp(current->username, username) == 0) {
-            found = 1;
-            
-            // Delete all reservations for this user first
-            Reservation* currentRes = reservationList;
-            Reservation* prevRes = NULL;
-            
-            while (currentRes != NULL) {
-                if (strcmp(currentRes->username, username) == 0) {
-                    if (prevRes == NULL) {
-                        reservationList = currentRes->next;
-                        free(currentRes);
-                        currentRes = reservationList;
-                    } else {
-                        prevRes->next = currentRes->next;
-                        free(currentRes);
-                        currentRes = prevRes->next;
-                    }
-                } else {
-                    prevRes = currentRes;
-                    currentRes = currentRes->next;
-                }
-            }
-            
-            // Now delete the user
-            if (prev == NULL) {
-                userList = current->next;
-            } else {
-                prev->next = current->next;
-            }
-            
-            free(current);
-            
-            // Save data immediately after deleting a user
-            saveData();
-            
-            char message[100];
-            sprintf(message, "User %s and all their reservations have been deleted.", username);
-            displayHeader("USER DELETED");
-            displayMessage(message);
-            return;
-        }
-        prev = current;
-        current = current->next;
-    }
-    
-    if (!found) {
+    if (status == HOTEL_ERR_NOT_FOUND) {
         displayMessage("Error: User not found.");
+        return;
     }
+    
+    char message[150];
+    sprintf(message, "User %s and all their reservations have been deleted.", username);
+    displayHeader("USER DELETED");
+    displayMessage(message);
 }
 
 void viewAllReservations() {
     displayHeader("ALL RESERVATIONS");
     
-    Reservation* current = reservationList;
+    ReservationFilter filter = { 0, 0, SCAN_FIRST_DAY, SCAN_LAST_DAY };
+    int count = hotelStats.totalReservations;
+    int i;
     
-    if (current == NULL) {
+    if (count == 0) {
         displayMessage("No reservations found.");
         return;
     }
     
+    // The column scan hands them out in booking order
+    Reservation** matches = (Reservation**)malloc(count * sizeof(Reservation*));
+    count = scanReservations(&filter, matches, count);
+    
     printf("  %-10s %-8s %-25s %-25s\n", "Username", "Room #", "Check-in", "Check-out");
     printf("  ----------------------------------------------------------------------\n");
     
-    while (current != NULL) {
+    for (i = 0; i < count; i++) {
+        Reservation* current = matches[i];
         printf("  %-10s %-8d %-25s %-25s\n", 
                current->username, 
                current->roomNumber, 
                // Format check-in date and time together
-               formatDateTime(current->checkInDate, current->checkInTime),
+               formatDateTime(current->checkInDay, current->checkInMinute),
                // Format check-out date and time together
-               formatDateTime(current->checkOutDate, current->checkOutTime));
-        current = current->next;
+               formatDateTime(current->checkOutDay, current->checkOutMinute));
     }
     
+    free(matches);
     displayMessage("");
 }
 
 void viewStatistics() {
     displayHeader("HOTEL STATISTICS");
     
-    int totalReservations = 0;
-    int bookedRooms = 0;
+    // All figures are maintained as reservations and rooms change
+    int bookedRooms = hotelStats.bookedRooms;
+    int today, minute;
     int i;
     
-    Reservation* current = reservationList;
-    while (current != NULL) {
-        totalReservations++;
-        current = current->next;
-    }
-    
-    // Count unique booked rooms
-    for (i = 1; i <= totalRooms; i++) {
-        if (isRoomBooked(i)) {
-            bookedRooms++;
-        }
-    }
+    // Stays by date come from a scan of the reservation columns
+    getCurrentDateTime(&today, &minute);
+    ReservationFilter tonight = { 0, 0, today, today + 1 };
+    ReservationFilter nextMonth = { 0, 0, today, today + 30 };
     
     printf("  Total Rooms: %d\n", totalRooms);
     printf("  Booked Rooms: %d\n", bookedRooms);
     printf("  Available Rooms: %d\n", totalRooms - bookedRooms);
-    printf("  Total Reservations: %d\n", totalReservations);
+    printf("  Total Reservations: %d\n", hotelStats.totalReservations);
     printf("  Occupancy Rate: %d%%\n", totalRooms > 0 ? (bookedRooms * 100) / totalRooms : 0);
+    printf("  Stays Over Today: %d\n", countReservations(&tonight));
+    printf("  Stays In The Next 30 Days: %d\n", countReservations(&nextMonth));
+    
+    printf("\n  %-15s %-8s %-8s %-14s %-10s\n", "Room Type", "Rooms", "Booked", "Reservations", "Occupancy");
+    printf("  ----------------------------------------------------------\n");
+    for (i = 0; i < hotelStats.typeCount; i++) {
+        RoomTypeStats* stats = &hotelStats.types[i];
+        if (stats->rooms == 0) {
+            continue;
+        }
+        printf("  %-15s %-8d %-8d %-14d %d%%\n", roomTypes[i].name, stats->rooms, stats->bookedRooms,
+               stats->reservations, (stats->bookedRooms * 100) / stats->rooms);
+    }
+    
+    // Nights already on the books, from the night ledgers
+    OccupancyReport forecast;
+    printf("\n  Next 30 Days:\n");
+    printf("  %-15s %-8s %-10s %-10s %-10s\n", "Room Type", "Nights", "Occupancy", "ADR", "RevPAR");
+    printf("  ----------------------------------------------------------\n");
+    for (i = 0; i <= roomTypeCount; i++) {
+        const char* name = i < roomTypeCount ? roomTypes[i].name : "All";
+        if (i < roomTypeCount && roomTypes[i].roomCount == 0) {
+            continue;
+        }
+        if (occupancyReport(i < roomTypeCount ? name : "all", today, today + 30, &forecast)) {
+            printf("  %-15s %-8.0f %-9.1f%% %-10.2f %-10.2f\n", name, forecast.roomNights, forecast.occupancy,
+                   forecast.adr, forecast.revpar);
+        }
+    }
+    
+    // Checked-out stays come from the archive on disk, a block at a time
+    ArchiveMonthReport report[REPORT_MONTHS];
+    char month[8];
+    
+    printf("\n  %-10s %-8s %-8s %-14s %-10s\n", "Month", "Stays", "Nights", "Revenue", "Occupancy");
+    printf("  ----------------------------------------------------------\n");
+    if (archiveReport(dayToMonth(today) - (REPORT_MONTHS - 1), REPORT_MONTHS, report)) {
+        for (i = 0; i < REPORT_MONTHS; i++) {
+            int roomDays = totalRooms * (monthStartDay(report[i].month + 1) - monthStartDay(report[i].month));
+            formatMonth(report[i].month, month);
+            printf("  %-10s %-8d %-8d %-14.2f %d%%\n", month, report[i].stays, report[i].roomNights,
+                   report[i].revenue, roomDays > 0 ? (report[i].roomNights * 100) / roomDays : 0);
+        }
+    } else {
+        printf("  Error: Could not read the archive.\n");
+    }
+    
+    printf("\n  Memory Pools (in use / allocated):\n");
+    printf("  Reservations: %d / %d in %d chunks\n", reservationPool.inUse,
+           reservationPool.chunkCount * reservationPool.itemsPerChunk, reservationPool.chunkCount);
+    printf("  Users: %d / %d in %d chunks\n", userPool.inUse,
+           userPool.chunkCount * userPool.itemsPerChunk, userPool.chunkCount);
+    
+    displayMessage("");
+}
+
+void viewMetrics() {
+    displayHeader("PERFORMANCE METRICS");
+    
+    int i;
+    printf("  %-14s %-9s %-10s %-10s %-10s %-10s\n", "Operation", "Calls", "p50 (us)", "p99 (us)", "Max (us)", "Mean (us)");
+    printf("  ------------------------------------------------------------------\n");
+    for (i = 0; i < METRIC_OPERATION_COUNT; i++) {
+        LatencyHistogram* histogram = &metricHistograms[i];
+        printf("  %-14s %-9llu %-10.1f %-10.1f %-10.1f %-10.1f\n", metricName((MetricOperation)i), histogram->count,
+               histogramPercentile(histogram, 0.50) / 1000.0, histogramPercentile(histogram, 0.99) / 1000.0,
+               histogram->maxNanos / 1000.0,
+               histogram->count > 0 ? histogram->totalNanos / 1000.0 / histogram->count : 0.0);
+    }
+    
+    printf("\n  Last snapshot: %llu bytes (%llu bytes over all saves)\n",
+           metricCounters[COUNTER_LAST_SAVE_BYTES], metricCounters[COUNTER_SAVE_BYTES]);
+    printf("  Journal: %llu records, %llu bytes\n",
+           metricCounters[COUNTER_JOURNAL_RECORDS], metricCounters[COUNTER_JOURNAL_BYTES]);
+    printf("  Expired reservations: %llu (%llu archived in %llu bytes, %d partitions)\n",
+           metricCounters[COUNTER_EXPIRED], metricCounters[COUNTER_ARCHIVED],
+           metricCounters[COUNTER_ARCHIVE_BYTES], archivePartitionCount);
+    printf("  User table: %d of %d slots, expiry heap: %d entries\n",
+           userTableCount, userTableCapacity, expiryHeapSize);
+    
+    if (metricsDumpJson(METRICS_FILE)) {
+        printf("\n  Metrics written to %s\n", METRICS_FILE);
+    } else {
+        printf("\n  Error: Could not write %s\n", METRICS_FILE);
+    }
     
     displayMessage("");
 }
@@ -955,37 +871,70 @@ void viewStatistics() {
 void searchAvailableRooms() {
     displayHeader("SEARCH ROOMS");
     
+    int i;
     printf("  Available Room Types:\n");
-    printf("  1. Standard - Basic comfortable room\n");
-    printf("  2. Deluxe - Spacious room with better amenities\n");
-    printf("  3. Suite - Luxury accommodation\n");
+    for (i = 0; i < roomTypeCount; i++) {
+        if (roomTypes[i].roomCount == 0) {
+            continue;
+        }
+        printf("  - %s (P%.0f/night)", roomTypes[i].name, roomTypes[i].pricePerNight);
+        if (roomTypes[i].description[0] != '\0') {
+            printf(" - %s", roomTypes[i].description);
+        }
+        printf("\n");
+    }
     
     char roomType[MAX_ROOM_TYPE_LEN];
+    char checkInDate[11], checkOutDate[11];
     printf("\n  Enter room type to search (or 'all' for all types): ");
     scanf("%s", roomType);
     
-    printf("\n  %s Rooms:\n", strcmp(roomType, "all") == 0 ? "All" : roomType);
+    printf("  Enter check-in date (YYYY-MM-DD): ");
+    scanf("%10s", checkInDate);
+    
+    if (!isValidDate(checkInDate)) {
+        displayMessage("Error: Invalid date format.");
+        return;
+    }
+    
+    printf("  Enter check-out date (YYYY-MM-DD): ");
+    scanf("%10s", checkOutDate);
+    
+    if (!isValidDate(checkOutDate)) {
+        displayMessage("Error: Invalid date format.");
+        return;
+    }
+    
+    int checkInDay = dateToDay(checkInDate);
+    int checkOutDay = dateToDay(checkOutDate);
+    if (checkInDay > checkOutDay) {
+        displayMessage("Error: Check-in date must not be after check-out date.");
+        return;
+    }
+    
+    int* roomNumbers = (int*)malloc((totalRooms + 1) * sizeof(int));
+    int count = searchRooms(roomType, checkInDay, checkOutDay, roomNumbers, totalRooms);
+    
+    printf("\n  %s Rooms free from %s to %s:\n", strcmp(roomType, "all") == 0 ? "All" : roomType, checkInDate, checkOutDate);
     printf("\n  %-8s %-20s %-12s %-15s\n", "Room #", "Room Type", "Status", "Price/Night(P)");
     printf("  ----------------------------------------------------------\n");
     
-    int i, found = 0;
-    for (i = 0; i < totalRooms; i++) {
-        if (strcmp(roomType, "all") == 0 || strcmp(rooms[i].roomType, roomType) == 0) {
-            printf("  %-8d %-20s %-12s P%-14.0f\n", 
-                   rooms[i].roomNumber, 
-                   rooms[i].roomType,
-                   "Available", // Always show as available
-                   rooms[i].pricePerNight);
-            found = 1;
-        }
+    for (i = 0; i < count; i++) {
+        Room* room = findRoom(roomNumbers[i]);
+        printf("  %-8d %-20s %-12s P%-14.0f\n", 
+               room->roomNumber, 
+               roomTypes[room->typeId].name,
+               "Available",
+               roomTypes[room->typeId].pricePerNight);
     }
     
-    if (!found) {
+    if (count == 0) {
         char message[100];
-        sprintf(message, "No rooms of type %s found.", roomType);
+        sprintf(message, "No %s rooms are free for those dates.", roomType);
         printf("  %s\n", message);
     }
     
+    free(roomNumbers);
     displayMessage("");
 }
 
@@ -993,6 +942,11 @@ void showAdminMenu() {
     int choice;
     
     do {
+        // Expiry is a heap peek when nothing is due, so it runs before every action
+        if (!checkExpiredReservations()) {
+            displayMessage("Error: Could not archive expired reservations.");
+        }
+        checkSnapshot();
         displayHeader("ADMIN MENU");
         
         char* adminOptions[] = {
@@ -1003,12 +957,14 @@ void showAdminMenu() {
             "Remove a reservation",
             "Delete a user",
             "View statistics",
+            "View performance metrics",
             "Search available rooms",
+            "Re-optimize room assignments",
             "Log out"
         };
         
         printf("  Use UP/DOWN keys to navigate and ENTER to select:\n\n");
-        choice = getMenuChoice(adminOptions, 9);
+        choice = getMenuChoice(adminOptions, 11);
         
         switch (choice) {
             case 1:
@@ -1050,25 +1006,55 @@ void showAdminMenu() {
                 viewStatistics();
                 break;
             case 8:
-                searchAvailableRooms();
+                viewMetrics();
                 break;
             case 9:
+                searchAvailableRooms();
+                break;
+            case 10:
+                reoptimizeRooms();
+                break;
+            case 11:
     displayHeader("LOGGING OUT");
     printf("  Saving data and logging out...\n");
     
-    // Save data before logout
-    saveData();
+    // Save data before logout; the file is written in the background
+    startBackgroundSnapshot();
     
     // Don't do cleanup or reload here
     break;
         }
-    } while (choice != 9);
+    } while (choice != 11);
+}
+
+// Move bookings the hotel assigned that have not checked in yet, to close up short gaps
+void reoptimizeRooms() {
+    displayHeader("RE-OPTIMIZE ROOM ASSIGNMENTS");
+    
+    ReoptimizeResult result;
+    int today, minute;
+    getCurrentDateTime(&today, &minute);
+    
+    if (hotelReoptimize("all", today, minute, &result) != HOTEL_OK) {
+        displayMessage("Error: Not enough memory to re-optimize.");
+        return;
+    }
+    
+    printf("  Bookings that may move:    %d\n", result.candidates);
+    printf("  Bookings moved:            %d\n", result.moved);
+    printf("  Orphan days (gaps of %d or fewer days between stays): %d -> %d\n",
+           FIT_ORPHAN_DAYS, result.orphanDaysBefore, result.orphanDaysAfter);
+    displayMessage("");
 }
 
 void showUserMenu(char username[]) {
     int choice;
     
     do {
+        if (!checkExpiredReservations()) {
+            displayMessage("Error: Could not archive expired reservations.");
+        }
+        checkSnapshot();
         displayHeader("USER MENU");
         
         char* userOptions[] = {
@@ -1103,8 +1089,8 @@ void showUserMenu(char username[]) {
     displayHeader("LOGGING OUT");
     printf("  Saving data and logging out...\n");
     
-    // IMPORTANT: Save data before logout
-    saveData();
+    // IMPORTANT: Save data before logout; the file is written in the background
+    startBackgroundSnapshot();
     
     // Don't clear the lists here - we'll do it in main() after returning
     break;
@@ -1124,13 +1110,9 @@ void registerUser() {
     scanf("%s", username);
     
     // Check if username already exists
-    User* current = userList;
-    while (current != NULL) {
-        if (strcmp(current->username, username) == 0) {
-            displayMessage("Error: Username already exists.\nPlease choose a different username.");
-            return;
-        }
-        current = current->next;
+    if (findUser(username) != NULL) {
+        displayMessage("Error: Username already exists.\nPlease choose a different username.");
+        return;
     }
     
     printf("  Enter a password: ");
@@ -1150,205 +1132,22 @@ void registerUser() {
     }
     password[i] = '\0';
     
-    addUser(username, password, 0);
-    
-    // Save data immediately after registering a user
-    saveData();
+    hotelRegister(username, password, 0);
     
     displayHeader("REGISTRATION SUCCESSFUL");
     displayMessage("You can now log in with your credentials.");
 }
 
-void cleanup() {
-    User* currentUser = userList;
-    while (currentUser != NULL) {
-        User* temp = currentUser;
-        currentUser = currentUser->next;
-        free(temp);
-    }
-    userList = NULL;
-    
-    Reservation* currentReservation = reservationList;
-    while (currentReservation != NULL) {
-        Reservation* temp = currentReservation;
-        currentReservation = currentReservation->next;
-        free(temp);
-    }
-    reservationList = NULL;
-    
-    free(rooms);
-    rooms = NULL;
-}
-
-void saveData() {
-    FILE* file = fopen(DATA_FILE, "w");
-    if (file == NULL) {
-        displayMessage("Error: Could not open file for writing.");
-        return;
-    }
-    
-    // Save users
-    User* currentUser = userList;
-    while (currentUser != NULL) {
-        fprintf(file, "USER:%s:%s:%d\n", currentUser->username, currentUser->password, currentUser->isAdmin);
-        currentUser = currentUser->next;
-    }
-    
-    // Save reservations
-    Reservation* currentReservation = reservationList;
-    while (currentReservation != NULL) {
-        fprintf(file, "RESERVATION:%s:%d:%s:%s:%s:%s\n", 
-                currentReservation->username, 
-                currentReservation->roomNumber, 
-                currentReservation->checkInDate, 
-                currentReservation->checkInTime, 
-                currentReservation->checkOutDate, 
-                currentReservation->checkOutTime);
-        currentReservation = currentReservation->next;
-    }
-    
-    // Save room information
-    int i;
-    for (i = 0; i < totalRooms; i++) {
-        fprintf(file, "ROOM:%d:%s:%.2f\n", 
-                rooms[i].roomNumber, 
-                rooms[i].roomType, 
-                rooms[i].pricePerNight);
-    }
-    
-    fclose(file);
-}
-
-void loadData() {
-    FILE* file = fopen(DATA_FILE, "r");
-    if (file == NULL) {
-        // File doesn't exist yet, not an error
-        return;
+int main(int argc, char* argv[]) {
+    // Converter between the binary snapshot and the text format:
+    //   --to-text <snapshot.bin> <data.txt>
+    //   --to-binary <data.txt> <snapshot.bin>
+    if (argc == 4 && (strcmp(argv[1], "--to-text") == 0 || strcmp(argv[1], "--to-binary") == 0)) {
+        int success = hotelConvert(strcmp(argv[1], "--to-text") == 0, argv[2], argv[3]) == HOTEL_OK;
+        printf("%s %s -> %s\n", success ? "Converted" : "Error: Could not convert", argv[2], argv[3]);
+        return success ? 0 : 1;
     }
     
-    char line[256];
-    while (fgets(line, sizeof(line), file)) {
-        char type[20];
-        int i = 0;
-        while (line[i] != ':' && i < 19) {
-            type[i] = line[i];
-            i++;
-        }
-        type[i] = '\0';
-        
-        if (strcmp(type, "USER") == 0) {
-            char username[MAX_NAME_LEN], password[MAX_PASSWORD_LEN];
-            int isAdmin;
-            sscanf(line, "USER:%[^:]:%[^:]:%d", username, password, &isAdmin);
-            addUser(username, password, isAdmin);
-        } else if (strcmp(type, "RESERVATION") == 0) {
-            char username[MAX_NAME_LEN], checkInDate[11], checkInTime[6], checkOutDate[11], checkOutTime[6];
-            int roomNumber;
-            sscanf(line, "RESERVATION:%[^:]:%d:%[^:]:%[^:]:%[^:]:%[^\n]", 
-                   username, &roomNumber, checkInDate, checkInTime, checkOutDate, checkOutTime);
-            addReservation(username, roomNumber, checkInDate, checkInTime, checkOutDate, checkOutTime);
-        } else if (strcmp(type, "ROOM") == 0) {
-            int roomNumber;
-            char roomType[MAX_ROOM_TYPE_LEN];
-            double pricePerNight;
-            sscanf(line, "ROOM:%d:%[^:]:%lf", &roomNumber, roomType, &pricePerNight);
-            
-            // If we need to expand the rooms array
-            while (roomNumber > totalRooms) {
-                resizeRooms();
-                totalRooms++;
-            }
-            
-            rooms[roomNumber - 1].roomNumber = roomNumber;
-            strcpy(rooms[roomNumber - 1].roomType, roomType);
-            rooms[roomNumber - 1].pricePerNight = pricePerNight;
-        }
-    }
-    
-    fclose(file);
-}
-
-void updateRoomPrices(void) {
-    int i;
-    for (i = 0; i < totalRooms; i++) {
-        if (strcmp(rooms[i].roomType, "Standard") == 0) {
-            rooms[i].pricePerNight = 1500.0;
-        } else if (strcmp(rooms[i].roomType, "Deluxe") == 0) {
-            rooms[i].pricePerNight = 2000.0;
-        } else if (strcmp(rooms[i].roomType, "Suite") == 0) {
-            rooms[i].pricePerNight = 3000.0;
-        }
-    }
-}
-
-void checkExpiredReservations() {
-    time_t now = time(NULL);
-    struct tm* currentTime = localtime(&now);
-    char currentDate[11];
-    char currentTimeStr[6];
-    int year = currentTime->tm_year + 1900;
-    int month = currentTime->tm_mon + 1;
-    int day = currentTime->tm_mday;
-    int hour = currentTime->tm_hour;
-    int minute = currentTime->tm_min;
-
-    snprintf(currentDate, sizeof(currentDate), "%04d-%02d-%02d", year, month, day);
-    snprintf(currentTimeStr, sizeof(currentTimeStr), "%02d:%02d", hour, minute);
-
-    Reservation* current = reservationList;
-    Reservation* prev = NULL;
-    
-    while (current != NULL) {
-        if (compareDates(current->checkOutDate, currentDate) < 0 || 
-            (compareDates(current->checkOutDate, currentDate) == 0 && strcmp(current->checkOutTime, currentTimeStr) < 0)) {
-            // This reservation has expired
-            if (prev == NULL) {
-                reservationList = current->next;
-                Reservation* temp = current;
-                current = current->next;
-                free(temp);
-            } else {
-                prev->next = current->next;
-                Reservation* temp = current;
-                current = current->next;
-                free(temp);
-            }
-        } else {
-            prev = current;
-            current = current->next;
-        }
-    }
-}
-
-int compareDates(char date1[], char date2[]) {
-    // Parse the dates into year, month, day components
-    int year1, month1, day1;
-    int year2, month2, day2;
-    
-    sscanf(date1, "%d-%d-%d", &year1, &month1, &day1);
-    sscanf(date2, "%d-%d-%d", &year2, &month2, &day2);
-    
-    // Compare years
-    if (year1 != year2) {
-        return year1 - year2;
-    }
-    
-    // If years are equal, compare months
-    if (month1 != month2) {
-        return month1 - month2;
-    }
-    
-    // If months are equal, compare days
-    return day1 - day2;
-}
-
-char* formatDateTime(char date[], char time[]) {
-    static char formatted[30];
-    sprintf(formatted, "%s %s", date, time);
-    return formatted;
-}
-
-int main() {
     char* mainOptions[] = {
         "Register",
         "Login",
@@ -1359,19 +1158,16 @@ int main() {
     char username[MAX_NAME_LEN], password[MAX_PASSWORD_LEN];
     User* loggedInUser = NULL;
     
-    // Initialize and load data only once at program start
-    initializeRooms();
-    loadData();
-    updateRoomPrices();
-    checkExpiredReservations();
-    
-    // Add default users if they don't exist
-    if (userList == NULL) {
-        addUser("admin", "admin123", 1);
-        addUser("user1", "password1", 0);
-    }
+    // Initialize and load data only once at program start. Mutations are
+    // acknowledged when queued and written before the next keypress.
+    hotelSetPersistence(PERSIST_RELAXED, DEFAULT_PERSIST_WINDOW_MS, 0);
+    hotelInit();
     
     do {
+        if (!checkExpiredReservations()) {
+            displayMessage("Error: Could not archive expired reservations.");
+        }
+        checkSnapshot();
         displayHeader("HOTEL RESERVATION SYSTEM");
         
         printf("  Use UP/DOWN keys to navigate and ENTER to select:\n\n");
@@ -1429,7 +1225,10 @@ int main() {
             case 3:
                 displayHeader("EXITING");
                 printf("  Saving data and exiting...\n");
-                saveData();
+                waitForSnapshot();
+                if (hotelSave() != HOTEL_OK) {
+                    displayMessage("Error: Could not open file for writing.");
+                }
                 break;
             default:
                 displayMessage("Error: Invalid choice!");
@@ -1437,6 +1236,6 @@ int main() {
         }
     } while (option != 3);
     
-    cleanup(); // Only clean up at program exit
+    hotelShutdown(); // Only clean up at program exit
     return 0;
 }
@@ -0,0 +1,39 @@
+#!/bin/sh
+# Run every command file in tests/ through the batch runner and diff its
+# output with the .expected file next to it. Run from the repository root:
+#
+#   tests/run.sh [path to hotel_batch]
+#
+# <name>.txt runs against a prefix with no files yet. <name>.1.txt,
+# <name>.2.txt, ... run one after the other against the same prefix, so the
+# later runs start from what the earlier ones left on disk. Files named
+# <name>.seed.<ext> are copied to <prefix>.<ext> before the first run.
+
+batch=${1:-./hotel_batch}
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+failures=0
+
+for commands in tests/*.txt; do
+    run=${commands%.txt}
+    name=${run%.[0-9]}
+    if [ "$name" = "$run" ] || [ "${run##*.}" = 1 ]; then
+        rm -f "$work"/check.*
+        for seed in "$name".seed.*; do
+            if [ -e "$seed" ]; then
+                cp "$seed" "$work/check.${seed##*.seed.}"
+            fi
+        done
+    fi
+
+    "$batch" "$commands" "$work/check" 2>/dev/null >"$work/output"
+    if diff "$run.expected" "$work/output" >"$work/diff"; then
+        echo "ok   $run"
+    else
+        echo "FAIL $run"
+        cat "$work/diff"
+        failures=$((failures + 1))
+    fi
+done
+
+[ "$failures" -eq 0 ]